@@ -0,0 +1,33 @@
+#include <arena.h>
+
+#include <algorithm>
+#include <cstdint>
+
+Arena::Arena(size_t first_block_size)
+    : cur_(nullptr), end_(nullptr), used_(0), last_block_size_(0), refs_(0) {
+    AddBlock(std::max(kMinBlockSize, first_block_size));
+}
+
+void* Arena::Allocate(size_t size, size_t align) {
+    size_t padding = -reinterpret_cast<uintptr_t>(cur_) & (align - 1);
+    if (static_cast<size_t>(end_ - cur_) < padding + size) {
+        // blocks grow with the arena, so a big program needs few of them
+        AddBlock(std::max(2 * last_block_size_, size + align));
+        padding = -reinterpret_cast<uintptr_t>(cur_) & (align - 1);
+    }
+    char* ret = cur_ + padding;
+    cur_ = ret + size;
+    used_ += padding + size;
+    return ret;
+}
+
+size_t Arena::BytesUsed() const {
+    return used_;
+}
+
+void Arena::AddBlock(size_t size) {
+    blocks_.emplace_back(new char[size]);
+    cur_ = blocks_.back().get();
+    end_ = cur_ + size;
+    last_block_size_ = size;
+}
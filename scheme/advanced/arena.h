@@ -0,0 +1,98 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+template <class T>
+class ArenaAllocator;
+
+// Bump allocator for objects that die together, e.g. the nodes of one parsed program.
+// Single allocations are never freed, all memory goes back at once with the arena.
+//
+// An arena is owned by the ArenaAllocators created from it and is deleted with the last
+// one. The count is not atomic: like the rest of the interpreter, arenas are single-threaded.
+class Arena {
+public:
+    explicit Arena(size_t first_block_size);
+
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+
+    void* Allocate(size_t size, size_t align);
+
+    // Bytes handed out so far, including alignment padding.
+    size_t BytesUsed() const;
+
+private:
+    template <class T>
+    friend class ArenaAllocator;
+
+    static constexpr size_t kMinBlockSize = 256;
+
+    void AddBlock(size_t size);
+
+    char* cur_;
+    char* end_;
+    size_t used_;
+    size_t last_block_size_;
+    size_t refs_;
+    std::vector<std::unique_ptr<char[]>> blocks_;
+};
+
+// Allocator for std::allocate_shared. Every object allocated through it keeps the arena
+// alive, so objects that outlive the code that created the arena stay valid.
+template <class T>
+class ArenaAllocator {
+public:
+    using value_type = T;
+
+    // Takes ownership of an arena created with new.
+    explicit ArenaAllocator(Arena* arena) : arena_(arena) {
+        ++arena_->refs_;
+    }
+
+    ArenaAllocator(const ArenaAllocator& other) : arena_(other.arena_) {
+        ++arena_->refs_;
+    }
+
+    template <class U>
+    ArenaAllocator(const ArenaAllocator<U>& other) : arena_(other.arena_) {
+        ++arena_->refs_;
+    }
+
+    ArenaAllocator& operator=(const ArenaAllocator&) = delete;
+
+    ~ArenaAllocator() {
+        if (--arena_->refs_ == 0) {
+            delete arena_;
+        }
+    }
+
+    T* allocate(size_t n) {
+        return static_cast<T*>(arena_->Allocate(n * sizeof(T), alignof(T)));
+    }
+
+    void deallocate(T*, size_t) {
+    }
+
+    Arena* GetArena() const {
+        return arena_;
+    }
+
+    template <class U>
+    bool operator==(const ArenaAllocator<U>& other) const {
+        return arena_ == other.arena_;
+    }
+
+    template <class U>
+    bool operator!=(const ArenaAllocator<U>& other) const {
+        return arena_ != other.arena_;
+    }
+
+private:
+    template <class U>
+    friend class ArenaAllocator;
+
+    Arena* arena_;
+};
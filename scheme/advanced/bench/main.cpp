@@ -0,0 +1,408 @@
+#include <parser.h>
+#include <scheme.h>
+#include <incremental_tokenizer.h>
+#include <program_image.h>
+
+#include <chrono>
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <random>
+#include <sstream>
+#include <string>
+
+// Usage: scheme_advanced_bench [name...], runs every benchmark when no names are given.
+
+namespace {
+
+constexpr uint32_t kSeed = 16;
+
+template <class F>
+double Seconds(F&& f) {
+    auto start = std::chrono::steady_clock::now();
+    f();
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count();
+}
+
+void ReportThroughput(const std::string& name, size_t bytes, double seconds) {
+    std::cout << name << ": " << bytes / seconds / (1 << 20) << " MB/s" << std::endl;
+}
+
+// Nested lists of numbers and symbols, about `size` bytes long.
+std::string GenerateSource(size_t size) {
+    static const char* kSymbols[] = {"define", "lambda", "x", "list-tail", "+", "-", "<=",
+                                     "set-car!", "null?", "#t", "#f", "foo-bar-baz"};
+    std::mt19937 gen(kSeed);
+    std::uniform_int_distribution<int> kind(0, 9);
+    std::uniform_int_distribution<int> number(-100000, 100000);
+    std::uniform_int_distribution<size_t> symbol(0, std::size(kSymbols) - 1);
+    std::string source;
+    int depth = 0;
+    while (source.size() < size) {
+        int k = kind(gen);
+        if (k < 2) {
+            source += "(";
+            ++depth;
+        } else if (k < 4 && depth > 0) {
+            source += ")";
+            --depth;
+        } else if (k < 7) {
+            source += std::to_string(number(gen));
+        } else {
+            source += kSymbols[symbol(gen)];
+        }
+        source += k == 9 ? "\n" : " ";
+    }
+    source.append(depth, ')');
+    return source;
+}
+
+size_t CountTokens(Tokenizer* tokenizer) {
+    size_t count = 0;
+    while (!tokenizer->IsEnd()) {
+        ++count;
+        tokenizer->Next();
+    }
+    return count;
+}
+
+void BenchTokenizer() {
+    std::string source = GenerateSource(32 << 20);
+    size_t count = 0;
+    double stream_time = Seconds([&] {
+        std::stringstream ss{source};
+        Tokenizer tokenizer{&ss};
+        count += CountTokens(&tokenizer);
+    });
+    ReportThroughput("tokenizer/stream", source.size(), stream_time);
+    double buffer_time = Seconds([&] {
+        Tokenizer tokenizer{std::string_view(source)};
+        count += CountTokens(&tokenizer);
+    });
+    ReportThroughput("tokenizer/buffer", source.size(), buffer_time);
+    double all_time = Seconds([&] { count += TokenizeAll(source).size(); });
+    ReportThroughput("tokenizer/tokenize-all", source.size(), all_time);
+    double incremental_time = Seconds([&] {
+        constexpr size_t kChunk = 1500;
+        IncrementalTokenizer tokenizer;
+        for (size_t pos = 0; pos < source.size(); pos += kChunk) {
+            tokenizer.Feed(std::string_view(source).substr(pos, kChunk));
+            for (; !tokenizer.IsEnd(); tokenizer.Next()) {
+                ++count;
+            }
+        }
+        tokenizer.Finish();
+        count += tokenizer.TakeTokens().size();
+    });
+    ReportThroughput("tokenizer/incremental", source.size(), incremental_time);
+    std::cout << "tokens: " << count / 4 << std::endl;
+}
+
+void BenchParse() {
+    // many small top-level forms, the way Interpreter::Run sees them
+    std::string source;
+    while (source.size() < (16 << 20)) {
+        source += "(define (f x) (if (< x 2) '(1 . 2) (list x (f (- x 1)) 'foo)))\n";
+    }
+    auto tokens = TokenizeAll(source);
+    size_t count = 0;
+    double heap_time = Seconds([&] {
+        Tokenizer tokenizer{tokens};
+        while (!tokenizer.IsEnd()) {
+            count += Read(&tokenizer) != nullptr;
+        }
+    });
+    ReportThroughput("parse/heap", source.size(), heap_time);
+    double arena_time = Seconds([&] {
+        Tokenizer tokenizer{tokens};
+        while (!tokenizer.IsEnd()) {
+            ArenaAllocator<Object> arena(new Arena(4096));
+            count += Read(&tokenizer, arena) != nullptr;
+        }
+    });
+    ReportThroughput("parse/arena", source.size(), arena_time);
+    std::cout << "forms: " << count / 2 << std::endl;
+}
+
+// Evaluates the same program over and over, the parse cache keeps parsing out of the timing.
+void BenchEvalProgram(const std::string& name, const std::string& program, int repeats,
+                      const std::string& setup = "", Evaluator evaluator = DefaultEvaluator()) {
+    Interpreter interpreter(1, evaluator);
+    if (!setup.empty()) {
+        interpreter.RunAll(setup);
+    }
+    size_t count = interpreter.Run(program).size();
+    double time = Seconds([&] {
+        for (int i = 0; i < repeats; ++i) {
+            count += interpreter.Run(program).size();
+        }
+    });
+    std::cout << name << ": " << repeats / time << " evals/s (" << count % 10 << ")" << std::endl;
+}
+
+void BenchEval() {
+    std::string numbers;
+    for (int i = 0; i < 1000; ++i) {
+        numbers += " " + std::to_string(i);
+    }
+    BenchEvalProgram("eval/sum", "(+" + numbers + ")", 2000);
+    BenchEvalProgram("eval/compare", "(<" + numbers + ")", 2000);
+    BenchEvalProgram("eval/list?", "(list? '(" + numbers + "))", 2000);
+    BenchEvalProgram("eval/list-ref", "(list-ref '(" + numbers + ") 999)", 2000);
+    BenchEvalProgram("eval/vector-ref", "(vector-ref v 999)", 200000,
+                     "(define v (list->vector '(" + numbers + ")))");
+    BenchEvalProgram("eval/overflow", "(* 4294967296 4294967296 4294967296)", 200000);
+    BenchEvalProgram("eval/nested", "(if (> (abs (- 3 (* 2 5))) 4) (car (cons 1 2)) #f)", 200000);
+    BenchEvalProgram("eval/predicates",
+                     "(and (number? 1) (< 1 2) (not #f) (null? '()) (pair? '(1 . 2)) (boolean? #t))",
+                     200000);
+    BenchEvalProgram("eval/fib", "(fib 20)", 20,
+                     "(define (fib n) (if (< n 2) n (+ (fib (- n 1)) (fib (- n 2)))))");
+}
+
+void BenchLongList() {
+    std::string numbers;
+    for (int i = 0; i < 1000000; ++i) {
+        numbers += " " + std::to_string(i % 1000);
+    }
+    std::string setup = "(define l '(" + numbers + "))";
+    BenchEvalProgram("list/pair?", "(pair? l)", 200000, setup);
+    BenchEvalProgram("list/list-tail-1", "(pair? (list-tail l 1))", 200000, setup);
+    BenchEvalProgram("list/list-ref-10", "(list-ref l 10)", 200000, setup);
+    BenchEvalProgram("list/list-ref-last", "(list-ref l 999999)", 20, setup);
+    BenchEvalProgram("list/list?", "(list? l)", 20, setup);
+}
+
+// The same programs on the tree of nodes and on the bytecode machine.
+void BenchEvaluators() {
+    const std::string fib = "(define (fib n) (if (< n 2) n (+ (fib (- n 1)) (fib (- n 2)))))";
+    const std::string loop = "(define (loop n acc) (if (= n 0) acc (loop (- n 1) (+ acc n))))";
+    const std::string counter =
+        "(define (make-counter) (define n 0) (lambda () (set! n (+ n 1)) n)) "
+        "(define c (make-counter))";
+    for (auto [prefix, evaluator] : {std::pair{"tree", Evaluator::kTree},
+                                     std::pair{"bytecode", Evaluator::kBytecode}}) {
+        std::string name = prefix;
+        BenchEvalProgram(name + "/fib", "(fib 20)", 20, fib, evaluator);
+        BenchEvalProgram(name + "/loop", "(loop 1000 0)", 2000, loop, evaluator);
+        BenchEvalProgram(name + "/counter", "(c)", 200000, counter, evaluator);
+        BenchEvalProgram(name + "/nested", "(if (> (abs (- 3 (* 2 5))) 4) (car (cons 1 2)) #f)",
+                         200000, "", evaluator);
+    }
+}
+
+// Products of random numbers of a growing number of limbs, Karatsuba makes a product of
+// operands 16 times longer about 80 times slower instead of 256.
+void BenchBigInt() {
+    std::mt19937_64 gen(kSeed);
+    auto random = [&gen](int limbs) {
+        BigInt ret = 1;
+        for (int i = 0; i < limbs; ++i) {
+            ret = ret * BigInt(int64_t(1) << 32) + static_cast<int64_t>(gen() >> 32);
+        }
+        return ret;
+    };
+    size_t count = 0;
+    for (int limbs : {16, 256, 4096}) {
+        BigInt a = random(limbs);
+        BigInt b = random(limbs);
+        int repeats = (1 << 26) / limbs / limbs + 1;
+        double time = Seconds([&] {
+            for (int i = 0; i < repeats; ++i) {
+                count += (a * b).IsNegative();
+            }
+        });
+        std::cout << "bigint/mul-" << limbs << ": " << time / repeats * 1e6 << " us" << std::endl;
+    }
+    BigInt power = 3;
+    double time = Seconds([&] {
+        for (int i = 0; i < 14; ++i) {
+            power = power * power;
+        }
+    });
+    std::cout << "bigint/square-3^16384: " << time * 1e3 << " ms (" << count % 10 << ")" << std::endl;
+}
+
+void BenchCollect() {
+    constexpr int kLists = 10000;
+    constexpr int kLength = 100;
+    std::vector<std::shared_ptr<Object>> kept;
+    for (int i = 0; i < kLists; ++i) {
+        auto head = std::make_shared<Cell>(MakeNumber(i), nullptr);
+        auto tail = head;
+        for (int j = 1; j < kLength; ++j) {
+            auto cell = std::make_shared<Cell>(MakeNumber(j), nullptr);
+            tail->SetSecond(cell);
+            tail = cell;
+        }
+        // every other list is circular and dropped, the rest stays referenced
+        tail->SetSecond(head);
+        if (i % 2 == 0) {
+            kept.push_back(head);
+        }
+    }
+    CollectStats stats{};
+    double time = Seconds([&] { stats = CollectCycles(); });
+    std::cout << "collect: " << stats.nodes / time / 1e6 << " M nodes/s, freed " << stats.freed
+              << " of " << stats.nodes << std::endl;
+    for (auto& list : kept) {
+        As<Cell>(list)->SetSecond(nullptr);
+    }
+}
+
+// Builds and drops short lists, the way temporary argument lists are made.
+template <class MakeList>
+void BenchCells(const std::string& name, MakeList make_list) {
+    constexpr int kLists = 1000000;
+    constexpr int kLength = 8;
+    CellPool::ResetCounters();
+    size_t count = 0;
+    std::shared_ptr<Object> kept;
+    double time = Seconds([&] {
+        for (int i = 0; i < kLists; ++i) {
+            auto list = make_list(kLength);
+            count += list != nullptr;
+            // one list in a hundred survives until the next one is kept
+            if (i % 100 == 0) {
+                kept = list;
+            }
+        }
+    });
+    auto stats = CellPool::GetStats();
+    std::cout << name << ": " << kLists * kLength / time / 1e6 << " M cells/s";
+    if (stats.allocations) {
+        std::cout << ", survived " << stats.allocations - stats.frees << " of "
+                  << stats.allocations << ", reserved " << stats.reserved / 1024 << " KB";
+    }
+    std::cout << " (" << count % 10 << ")" << std::endl;
+}
+
+void BenchCellAllocation() {
+    BenchCells("cells/make-shared", [](int length) {
+        std::shared_ptr<Object> list;
+        for (int i = 0; i < length; ++i) {
+            list = std::make_shared<Cell>(MakeNumber(i), list);
+        }
+        return list;
+    });
+    BenchCells("cells/pool", [](int length) {
+        std::shared_ptr<Object> list;
+        for (int i = 0; i < length; ++i) {
+            list = MakeCell(MakeNumber(i), list);
+        }
+        return list;
+    });
+}
+
+void BenchFree() {
+    constexpr int kLength = 4000000;
+    std::shared_ptr<Object> list;
+    for (int i = 0; i < kLength; ++i) {
+        list = MakeCell(MakeNumber(i % 1000), list);
+    }
+    double time = Seconds([&] { list = nullptr; });
+    std::cout << "free/long: " << kLength / time / 1e6 << " M cells/s" << std::endl;
+
+    // a list of short lists
+    for (int i = 0; i < kLength / 4; ++i) {
+        auto item = MakeCell(MakeNumber(1), MakeCell(MakeNumber(2), MakeCell(MakeNumber(3), nullptr)));
+        list = MakeCell(item, list);
+    }
+    time = Seconds([&] { list = nullptr; });
+    std::cout << "free/nested: " << kLength / time / 1e6 << " M cells/s" << std::endl;
+}
+
+void BenchImage() {
+    std::string source = GenerateSource(16 << 20);
+    std::string image = CompileProgram(source);
+    std::cout << "image/size: " << image.size() * 100 / source.size() << "% of source"
+              << std::endl;
+    size_t count = 0;
+    double parse_time = Seconds([&] {
+        Tokenizer tokenizer{std::string_view(source)};
+        while (!tokenizer.IsEnd()) {
+            ArenaAllocator<Object> arena(new Arena(4096));
+            count += Read(&tokenizer, arena) != nullptr;
+        }
+    });
+    ReportThroughput("image/parse", source.size(), parse_time);
+    double load_time = Seconds([&] {
+        ProgramImage program{std::string_view(image)};
+        while (!program.IsEnd()) {
+            ArenaAllocator<Object> arena(new Arena(4096));
+            count += Read(&program, arena) != nullptr;
+        }
+    });
+    ReportThroughput("image/load", source.size(), load_time);
+    std::cout << "forms: " << count / 2 << std::endl;
+}
+
+void BenchRun() {
+    constexpr int kForms = 100000;
+    std::vector<std::string> forms;
+    std::string source;
+    for (int i = 0; i < kForms; ++i) {
+        forms.push_back("(+ " + std::to_string(i) + " (car '(1 2)))");
+        source += forms.back() + "\n";
+    }
+    size_t count = 0;
+    double run_time = Seconds([&] {
+        Interpreter interpreter;
+        for (const auto& form : forms) {
+            count += interpreter.Run(form).size();
+        }
+    });
+    ReportThroughput("run/one-by-one", source.size(), run_time);
+    double all_time = Seconds([&] {
+        Interpreter interpreter;
+        for (const auto& result : interpreter.RunAll(source)) {
+            count += result.size();
+        }
+    });
+    ReportThroughput("run/all", source.size(), all_time);
+    double stream_time = Seconds([&] {
+        Interpreter interpreter;
+        std::stringstream in{source};
+        std::stringstream out;
+        interpreter.RunStream(&in, &out);
+        count += out.str().size();
+    });
+    ReportThroughput("run/stream", source.size(), stream_time);
+    std::cout << "result bytes: " << count / 3 << std::endl;
+}
+
+const std::map<std::string, std::function<void()>> kBenchmarks{
+    {"bigint", BenchBigInt},
+    {"cells", BenchCellAllocation},
+    {"collect", BenchCollect},
+    {"eval", BenchEval},
+    {"evaluators", BenchEvaluators},
+    {"free", BenchFree},
+    {"image", BenchImage},
+    {"list", BenchLongList},
+    {"parse", BenchParse},
+    {"run", BenchRun},
+    {"tokenizer", BenchTokenizer},
+};
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    if (argc == 1) {
+        for (const auto& [name, bench] : kBenchmarks) {
+            bench();
+        }
+        return 0;
+    }
+    for (int i = 1; i < argc; ++i) {
+        auto it = kBenchmarks.find(argv[i]);
+        if (it == kBenchmarks.end()) {
+            std::cerr << "Unknown benchmark: " << argv[i] << std::endl;
+            return 1;
+        }
+        it->second();
+    }
+    return 0;
+}
@@ -0,0 +1,334 @@
+#include <bigint.h>
+
+#include <algorithm>
+#include <bit>
+#include <limits>
+
+namespace {
+
+using Limbs = std::vector<uint32_t>;
+
+constexpr uint64_t kLimbBase = uint64_t(1) << 32;
+
+void Trim(Limbs* a) {
+    while (!a->empty() && a->back() == 0) {
+        a->pop_back();
+    }
+}
+
+int CompareMagnitudes(const Limbs& a, const Limbs& b) {
+    if (a.size() != b.size()) {
+        return a.size() < b.size() ? -1 : 1;
+    }
+    for (size_t i = a.size(); i > 0; --i) {
+        if (a[i - 1] != b[i - 1]) {
+            return a[i - 1] < b[i - 1] ? -1 : 1;
+        }
+    }
+    return 0;
+}
+
+// acc += b << (32 * shift), acc grows as needed.
+void AddShifted(Limbs* acc, const uint32_t* b, size_t size, size_t shift) {
+    if (acc->size() < shift + size) {
+        acc->resize(shift + size);
+    }
+    uint64_t carry = 0;
+    for (size_t i = 0; i < size; ++i) {
+        uint64_t sum = uint64_t((*acc)[shift + i]) + b[i] + carry;
+        (*acc)[shift + i] = static_cast<uint32_t>(sum);
+        carry = sum >> 32;
+    }
+    for (size_t i = shift + size; carry; ++i) {
+        if (i == acc->size()) {
+            acc->push_back(0);
+        }
+        uint64_t sum = uint64_t((*acc)[i]) + carry;
+        (*acc)[i] = static_cast<uint32_t>(sum);
+        carry = sum >> 32;
+    }
+}
+
+// a -= b, the magnitude of a must not be less than b.
+void SubtractInPlace(Limbs* a, const uint32_t* b, size_t size) {
+    uint64_t borrow = 0;
+    for (size_t i = 0; i < a->size() && (i < size || borrow); ++i) {
+        uint64_t diff = uint64_t((*a)[i]) - (i < size ? b[i] : 0) - borrow;
+        (*a)[i] = static_cast<uint32_t>(diff);
+        borrow = (diff >> 32) & 1;
+    }
+    Trim(a);
+}
+
+Limbs MultiplySchoolbook(const uint32_t* a, size_t na, const uint32_t* b, size_t nb) {
+    Limbs ret(na + nb, 0);
+    for (size_t i = 0; i < na; ++i) {
+        uint64_t carry = 0;
+        for (size_t j = 0; j < nb; ++j) {
+            uint64_t cur = uint64_t(a[i]) * b[j] + ret[i + j] + carry;
+            ret[i + j] = static_cast<uint32_t>(cur);
+            carry = cur >> 32;
+        }
+        ret[i + nb] = static_cast<uint32_t>(carry);
+    }
+    Trim(&ret);
+    return ret;
+}
+
+Limbs Multiply(const uint32_t* a, size_t na, const uint32_t* b, size_t nb) {
+    if (na < nb) {
+        std::swap(a, b);
+        std::swap(na, nb);
+    }
+    if (nb < BigInt::kKaratsubaThreshold) {
+        return MultiplySchoolbook(a, na, b, nb);
+    }
+    size_t half = na / 2;
+    Limbs ret;
+    if (nb <= half) {
+        // too unbalanced to split both at the same point, cut a into pieces as long as b
+        for (size_t pos = 0; pos < na; pos += nb) {
+            Limbs part = Multiply(a + pos, std::min(nb, na - pos), b, nb);
+            AddShifted(&ret, part.data(), part.size(), pos);
+        }
+        Trim(&ret);
+        return ret;
+    }
+    // a = a1 * B^half + a0, b = b1 * B^half + b0, three products of half the size:
+    // a * b = z2 * B^(2 half) + (z1 - z2 - z0) * B^half + z0
+    Limbs z0 = Multiply(a, half, b, half);
+    Limbs z2 = Multiply(a + half, na - half, b + half, nb - half);
+    Limbs sum_a(a, a + half);
+    AddShifted(&sum_a, a + half, na - half, 0);
+    Limbs sum_b(b, b + half);
+    AddShifted(&sum_b, b + half, nb - half, 0);
+    Limbs z1 = Multiply(sum_a.data(), sum_a.size(), sum_b.data(), sum_b.size());
+    SubtractInPlace(&z1, z0.data(), z0.size());
+    SubtractInPlace(&z1, z2.data(), z2.size());
+    ret = std::move(z0);
+    AddShifted(&ret, z1.data(), z1.size(), half);
+    AddShifted(&ret, z2.data(), z2.size(), 2 * half);
+    Trim(&ret);
+    return ret;
+}
+
+// a = a * factor + addend.
+void MultiplyAddSmall(Limbs* a, uint32_t factor, uint32_t addend) {
+    uint64_t carry = addend;
+    for (uint32_t& limb : *a) {
+        uint64_t cur = static_cast<uint64_t>(limb) * factor + carry;
+        limb = static_cast<uint32_t>(cur);
+        carry = cur >> 32;
+    }
+    if (carry) {
+        a->push_back(static_cast<uint32_t>(carry));
+    }
+}
+
+// a /= divisor, returns the remainder.
+uint32_t DivideSmall(Limbs* a, uint32_t divisor) {
+    uint64_t rem = 0;
+    for (size_t i = a->size(); i > 0; --i) {
+        uint64_t cur = (rem << 32) | (*a)[i - 1];
+        (*a)[i - 1] = static_cast<uint32_t>(cur / divisor);
+        rem = cur % divisor;
+    }
+    Trim(a);
+    return static_cast<uint32_t>(rem);
+}
+
+// Long division of magnitudes, Knuth's algorithm D. v has at least two limbs and is not
+// greater than u.
+Limbs Divide(const Limbs& u, const Limbs& v) {
+    size_t n = v.size();
+    size_t m = u.size() - n;
+    // normalize so that the top limb of the divisor has its high bit set, which keeps the
+    // estimate of every quotient digit at most two too large
+    int shift = std::countl_zero(v.back());
+    Limbs vn(n);
+    Limbs un(u.size() + 1);
+    for (size_t i = n - 1; i > 0; --i) {
+        vn[i] = (v[i] << shift) | static_cast<uint32_t>(uint64_t(v[i - 1]) >> (32 - shift));
+    }
+    vn[0] = v[0] << shift;
+    un[u.size()] = static_cast<uint32_t>(uint64_t(u.back()) >> (32 - shift));
+    for (size_t i = u.size() - 1; i > 0; --i) {
+        un[i] = (u[i] << shift) | static_cast<uint32_t>(uint64_t(u[i - 1]) >> (32 - shift));
+    }
+    un[0] = u[0] << shift;
+
+    Limbs q(m + 1);
+    for (size_t j = m + 1; j-- > 0;) {
+        uint64_t num = (uint64_t(un[j + n]) << 32) | un[j + n - 1];
+        uint64_t qhat = num / vn[n - 1];
+        uint64_t rhat = num % vn[n - 1];
+        while (qhat >= kLimbBase || qhat * vn[n - 2] > ((rhat << 32) | un[j + n - 2])) {
+            --qhat;
+            rhat += vn[n - 1];
+            if (rhat >= kLimbBase) {
+                break;
+            }
+        }
+        // un[j..j+n] -= qhat * vn
+        int64_t borrow = 0;
+        for (size_t i = 0; i < n; ++i) {
+            uint64_t p = qhat * vn[i];
+            int64_t t = int64_t(un[i + j]) - borrow - int64_t(p & 0xFFFFFFFF);
+            un[i + j] = static_cast<uint32_t>(t);
+            borrow = int64_t(p >> 32) - (t >> 32);
+        }
+        int64_t t = int64_t(un[j + n]) - borrow;
+        un[j + n] = static_cast<uint32_t>(t);
+        if (t < 0) {
+            // qhat was one too large, add the divisor back
+            --qhat;
+            uint64_t carry = 0;
+            for (size_t i = 0; i < n; ++i) {
+                uint64_t sum = uint64_t(un[i + j]) + vn[i] + carry;
+                un[i + j] = static_cast<uint32_t>(sum);
+                carry = sum >> 32;
+            }
+            un[j + n] += static_cast<uint32_t>(carry);
+        }
+        q[j] = static_cast<uint32_t>(qhat);
+    }
+    Trim(&q);
+    return q;
+}
+
+}  // namespace
+
+BigInt::BigInt() : negative_(false) {
+}
+
+BigInt::BigInt(int64_t value) : negative_(value < 0) {
+    uint64_t magnitude = negative_ ? 0 - static_cast<uint64_t>(value) : value;
+    limbs_ = {static_cast<uint32_t>(magnitude), static_cast<uint32_t>(magnitude >> 32)};
+    Trim(&limbs_);
+}
+
+BigInt BigInt::FromString(std::string_view text) {
+    bool negative = !text.empty() && text[0] == '-';
+    if (negative) {
+        text.remove_prefix(1);
+    }
+    // nine decimal digits at a time, most significant first
+    Limbs limbs;
+    size_t chunk = text.size() % 9 ? text.size() % 9 : 9;
+    for (size_t pos = 0; pos < text.size(); pos += chunk, chunk = 9) {
+        uint32_t factor = 1;
+        uint32_t value = 0;
+        for (char digit : text.substr(pos, chunk)) {
+            factor *= 10;
+            value = value * 10 + (digit - '0');
+        }
+        MultiplyAddSmall(&limbs, factor, value);
+    }
+    return BigInt(negative, std::move(limbs));
+}
+
+BigInt::BigInt(bool negative, std::vector<uint32_t> limbs) : limbs_(std::move(limbs)) {
+    Trim(&limbs_);
+    negative_ = negative && !limbs_.empty();
+}
+
+bool BigInt::IsNegative() const {
+    return negative_;
+}
+
+bool BigInt::IsZero() const {
+    return limbs_.empty();
+}
+
+bool BigInt::FitsInt64() const {
+    if (limbs_.size() <= 1) {
+        return true;
+    }
+    if (limbs_.size() > 2) {
+        return false;
+    }
+    uint64_t magnitude = (uint64_t(limbs_[1]) << 32) | limbs_[0];
+    uint64_t limit = uint64_t(std::numeric_limits<int64_t>::max()) + (negative_ ? 1 : 0);
+    return magnitude <= limit;
+}
+
+int64_t BigInt::ToInt64() const {
+    uint64_t magnitude = 0;
+    for (size_t i = limbs_.size(); i > 0; --i) {
+        magnitude = (magnitude << 32) | limbs_[i - 1];
+    }
+    return static_cast<int64_t>(negative_ ? 0 - magnitude : magnitude);
+}
+
+std::string BigInt::ToString() const {
+    if (limbs_.empty()) {
+        return "0";
+    }
+    // nine decimal digits at a time, least significant first
+    constexpr uint32_t kChunk = 1000000000;
+    Limbs rest = limbs_;
+    std::vector<uint32_t> chunks;
+    while (!rest.empty()) {
+        chunks.push_back(DivideSmall(&rest, kChunk));
+    }
+    std::string ret = negative_ ? "-" : "";
+    ret += std::to_string(chunks.back());
+    for (size_t i = chunks.size() - 1; i > 0; --i) {
+        std::string digits = std::to_string(chunks[i - 1]);
+        ret.append(9 - digits.size(), '0');
+        ret += digits;
+    }
+    return ret;
+}
+
+int BigInt::Compare(const BigInt& other) const {
+    if (negative_ != other.negative_) {
+        return negative_ ? -1 : 1;
+    }
+    int magnitude = CompareMagnitudes(limbs_, other.limbs_);
+    return negative_ ? -magnitude : magnitude;
+}
+
+BigInt BigInt::operator-() const {
+    return BigInt(!negative_, limbs_);
+}
+
+BigInt operator+(const BigInt& a, const BigInt& b) {
+    if (a.negative_ == b.negative_) {
+        Limbs sum = a.limbs_;
+        AddShifted(&sum, b.limbs_.data(), b.limbs_.size(), 0);
+        return BigInt(a.negative_, std::move(sum));
+    }
+    const BigInt& larger = CompareMagnitudes(a.limbs_, b.limbs_) >= 0 ? a : b;
+    const BigInt& smaller = &larger == &a ? b : a;
+    Limbs diff = larger.limbs_;
+    SubtractInPlace(&diff, smaller.limbs_.data(), smaller.limbs_.size());
+    return BigInt(larger.negative_, std::move(diff));
+}
+
+BigInt operator-(const BigInt& a, const BigInt& b) {
+    return a + -b;
+}
+
+BigInt operator*(const BigInt& a, const BigInt& b) {
+    return BigInt(a.negative_ != b.negative_,
+                  Multiply(a.limbs_.data(), a.limbs_.size(), b.limbs_.data(), b.limbs_.size()));
+}
+
+BigInt operator/(const BigInt& a, const BigInt& b) {
+    bool negative = a.negative_ != b.negative_;
+    if (CompareMagnitudes(a.limbs_, b.limbs_) < 0) {
+        return BigInt();
+    }
+    if (b.limbs_.size() == 1) {
+        Limbs quotient = a.limbs_;
+        DivideSmall(&quotient, b.limbs_[0]);
+        return BigInt(negative, std::move(quotient));
+    }
+    return BigInt(negative, Divide(a.limbs_, b.limbs_));
+}
+
+
+bool operator==(const BigInt& a, const BigInt& b) {
+    return a.negative_ == b.negative_ && a.limbs_ == b.limbs_;
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Arbitrary-precision integer, the slow path of the arithmetic builtins once a result does not
+// fit into int64_t. The magnitude is kept as little-endian 32-bit limbs without leading zeros,
+// zero has no limbs and is never negative.
+class BigInt {
+public:
+    BigInt();
+
+    BigInt(int64_t value);
+
+    // The text is decimal digits after an optional minus, as ToString writes them.
+    static BigInt FromString(std::string_view text);
+
+    bool IsNegative() const;
+
+    bool IsZero() const;
+
+    bool FitsInt64() const;
+
+    // Only valid when FitsInt64.
+    int64_t ToInt64() const;
+
+    std::string ToString() const;
+
+    // -1, 0 or 1 as this is less than, equal to or greater than other.
+    int Compare(const BigInt& other) const;
+
+    BigInt operator-() const;
+
+    friend BigInt operator+(const BigInt& a, const BigInt& b);
+
+    friend BigInt operator-(const BigInt& a, const BigInt& b);
+
+    // Schoolbook for short operands, Karatsuba once both are kKaratsubaThreshold limbs long.
+    friend BigInt operator*(const BigInt& a, const BigInt& b);
+
+    // Rounds toward zero like the division of int64_t, b must not be zero.
+    friend BigInt operator/(const BigInt& a, const BigInt& b);
+
+
+    friend bool operator==(const BigInt& a, const BigInt& b);
+
+    static constexpr size_t kKaratsubaThreshold = 32;
+
+private:
+    // Drops leading zero limbs, zero is made non-negative.
+    BigInt(bool negative, std::vector<uint32_t> limbs);
+
+    bool negative_;
+    std::vector<uint32_t> limbs_;
+};
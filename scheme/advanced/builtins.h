@@ -0,0 +1,24 @@
+#pragma once
+
+#include <object.h>
+
+#include <cstddef>
+#include <memory>
+#include <span>
+
+using Arguments = std::span<const std::shared_ptr<Object>>;
+
+// A builtin procedure. It is called with its arguments already evaluated and throws
+// RuntimeError when they do not suit it.
+struct Function {
+    virtual std::shared_ptr<Object> operator()(Arguments args) = 0;
+
+    virtual ~Function() = default;
+};
+
+// The Builtin object bound to the name, nullptr if there is none.
+std::shared_ptr<Object> FindBuiltin(SymbolId name);
+
+// Counts the global definitions that shadow a builtin. Calls bound to a builtin at compile
+// time check it, so that a later (define (+ ...) ...) still takes effect.
+inline size_t builtin_redefinitions = 0;
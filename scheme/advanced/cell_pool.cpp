@@ -0,0 +1,86 @@
+#include <cell_pool.h>
+
+#include <new>
+
+namespace {
+
+constexpr size_t kGranularity = 16;
+constexpr size_t kMaxPooledSize = 256;
+constexpr size_t kSizeClasses = kMaxPooledSize / kGranularity;
+constexpr size_t kSlabSize = 64 << 10;
+
+struct FreeBlock {
+    FreeBlock* next;
+};
+
+// Everything is trivially destructible, so nodes freed by other static destructors at exit
+// still find the pool intact.
+struct PoolState {
+    FreeBlock* free_lists[kSizeClasses];
+    char* slab_cur;
+    char* slab_end;
+    // slabs are chained through their first bytes, so they stay reachable
+    void* slabs;
+    CellPool::Stats stats;
+};
+
+PoolState state;
+
+size_t SizeClass(size_t size) {
+    return (size + kGranularity - 1) / kGranularity - 1;
+}
+
+void* Carve(size_t size) {
+    if (static_cast<size_t>(state.slab_end - state.slab_cur) < size) {
+        // whatever is left of the old slab is too small for this class and is dropped
+        char* slab = static_cast<char*>(::operator new(kSlabSize));
+        *reinterpret_cast<void**>(slab) = state.slabs;
+        state.slabs = slab;
+        state.slab_cur = slab + kGranularity;
+        state.slab_end = slab + kSlabSize;
+        state.stats.reserved += kSlabSize;
+    }
+    void* ret = state.slab_cur;
+    state.slab_cur += size;
+    return ret;
+}
+
+}  // namespace
+
+void* CellPool::Allocate(size_t size) {
+    ++state.stats.allocations;
+    if (++state.stats.live > state.stats.peak_live) {
+        state.stats.peak_live = state.stats.live;
+    }
+    if (size == 0 || size > kMaxPooledSize) {
+        return ::operator new(size);
+    }
+    size_t cls = SizeClass(size);
+    if (FreeBlock* block = state.free_lists[cls]) {
+        state.free_lists[cls] = block->next;
+        return block;
+    }
+    return Carve((cls + 1) * kGranularity);
+}
+
+void CellPool::Deallocate(void* ptr, size_t size) {
+    ++state.stats.frees;
+    --state.stats.live;
+    if (size == 0 || size > kMaxPooledSize) {
+        ::operator delete(ptr);
+        return;
+    }
+    size_t cls = SizeClass(size);
+    auto* block = static_cast<FreeBlock*>(ptr);
+    block->next = state.free_lists[cls];
+    state.free_lists[cls] = block;
+}
+
+CellPool::Stats CellPool::GetStats() {
+    return state.stats;
+}
+
+void CellPool::ResetCounters() {
+    state.stats.allocations = 0;
+    state.stats.frees = 0;
+}
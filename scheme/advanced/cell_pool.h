@@ -0,0 +1,73 @@
+#pragma once
+
+#include <object.h>
+
+#include <cstddef>
+#include <memory>
+
+// Free-list allocator for cells and the other small nodes the evaluator creates and drops all
+// the time. Blocks are sorted into size classes of 16 bytes; a freed block goes to the list
+// of its class and is reused by the next allocation of that size, so a steady state of
+// building and dropping lists does not call malloc at all.
+//
+// Memory is taken from the system in slabs and never given back. The pool is not thread-safe,
+// like the rest of the interpreter.
+class CellPool {
+public:
+    struct Stats {
+        size_t allocations;
+        size_t frees;
+        // blocks in use now and at most so far
+        size_t live;
+        size_t peak_live;
+        // bytes taken from the system
+        size_t reserved;
+    };
+
+    static void* Allocate(size_t size);
+
+    static void Deallocate(void* ptr, size_t size);
+
+    static Stats GetStats();
+
+    // Starts counting allocations and frees from zero, e.g. to measure how much of one phase
+    // survives it: live blocks added during the phase are allocations - frees.
+    static void ResetCounters();
+};
+
+// Allocator for std::allocate_shared, stateless.
+template <class T>
+class PoolAllocator {
+public:
+    using value_type = T;
+
+    PoolAllocator() = default;
+
+    template <class U>
+    PoolAllocator(const PoolAllocator<U>&) {
+    }
+
+    T* allocate(size_t n) {
+        return static_cast<T*>(CellPool::Allocate(n * sizeof(T)));
+    }
+
+    void deallocate(T* ptr, size_t n) {
+        CellPool::Deallocate(ptr, n * sizeof(T));
+    }
+
+    template <class U>
+    bool operator==(const PoolAllocator<U>&) const {
+        return true;
+    }
+
+    template <class U>
+    bool operator!=(const PoolAllocator<U>&) const {
+        return false;
+    }
+};
+
+// A cell from the pool.
+inline std::shared_ptr<Cell> MakeCell(const std::shared_ptr<Object>& first,
+                                      const std::shared_ptr<Object>& second) {
+    return std::allocate_shared<Cell>(PoolAllocator<Cell>(), first, second);
+}
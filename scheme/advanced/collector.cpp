@@ -0,0 +1,170 @@
+#include <collector.h>
+
+#include <vector>
+
+class Collector {
+public:
+    CollectStats Collect() {
+        AddNodes<Cell>(Kind::CELL);
+        AddNodes<Lambda>(Kind::LAMBDA);
+        AddNodes<Frame>(Kind::FRAME);
+        AddNodes<Vector>(Kind::VECTOR);
+
+        for (size_t i = 0; i < nodes_.size(); ++i) {
+            ForEachReference(i, [this](size_t to) { ++nodes_[to].internal_refs; });
+        }
+
+        // a node with more owners than references from other nodes is held from outside
+        std::vector<size_t> stack;
+        for (size_t i = 0; i < nodes_.size(); ++i) {
+            long owners = nodes_[i].owners;
+            if (owners == 0 || owners > nodes_[i].internal_refs) {
+                nodes_[i].reachable = true;
+                stack.push_back(i);
+            }
+        }
+        while (!stack.empty()) {
+            size_t i = stack.back();
+            stack.pop_back();
+            ForEachReference(i, [this, &stack](size_t to) {
+                if (!nodes_[to].reachable) {
+                    nodes_[to].reachable = true;
+                    stack.push_back(to);
+                }
+            });
+        }
+
+        // keep the garbage alive while its references are cleared, so that nothing is freed
+        // while the nodes are still in use, and no destructor has to recurse afterwards
+        std::vector<std::shared_ptr<void>> garbage;
+        for (const auto& node : nodes_) {
+            if (!node.reachable) {
+                garbage.push_back(Share(node));
+            }
+        }
+        for (const auto& node : nodes_) {
+            if (!node.reachable) {
+                Clear(node);
+            }
+        }
+        CollectStats stats{nodes_.size(), garbage.size()};
+        nodes_.clear();
+        garbage.clear();
+        return stats;
+    }
+
+private:
+    enum class Kind { CELL, LAMBDA, FRAME, VECTOR };
+
+    struct Node {
+        Kind kind;
+        void* ptr;
+        long owners;
+        long internal_refs;
+        bool reachable;
+    };
+
+    template <class T>
+    void AddNodes(Kind kind) {
+        for (auto* link = Linked<T>::head_; link; link = link->link_next_) {
+            link->gc_index_ = nodes_.size();
+            auto* node = static_cast<T*>(link);
+            nodes_.push_back(Node{kind, node, node->weak_from_this().use_count(), 0, false});
+        }
+    }
+
+    template <class T>
+    static size_t IndexOf(T* node) {
+        return static_cast<Linked<T>*>(node)->gc_index_;
+    }
+
+    template <class F>
+    static void VisitObject(const std::shared_ptr<Object>& obj, F&& visit) {
+        if (Is<Cell>(obj)) {
+            visit(IndexOf(static_cast<Cell*>(obj.get())));
+        }
+        else if (Is<Lambda>(obj)) {
+            visit(IndexOf(static_cast<Lambda*>(obj.get())));
+        }
+        else if (Is<Vector>(obj)) {
+            visit(IndexOf(static_cast<Vector*>(obj.get())));
+        }
+    }
+
+    template <class F>
+    static void VisitFrame(const std::shared_ptr<Frame>& frame, F&& visit) {
+        if (frame) {
+            visit(IndexOf(frame.get()));
+        }
+    }
+
+    template <class F>
+    void ForEachReference(size_t i, F&& visit) const {
+        const Node& node = nodes_[i];
+        if (node.kind == Kind::CELL) {
+            auto* cell = static_cast<Cell*>(node.ptr);
+            VisitObject(cell->first_, visit);
+            VisitObject(cell->second_, visit);
+        }
+        else if (node.kind == Kind::LAMBDA) {
+            // constants in the compiled code are not followed, a list quoted in a lambda
+            // counts as held from outside and is never freed as a cycle
+            VisitFrame(static_cast<Lambda*>(node.ptr)->frame_, visit);
+        }
+        else if (node.kind == Kind::VECTOR) {
+            for (const auto& obj : static_cast<Vector*>(node.ptr)->elements_) {
+                VisitObject(obj, visit);
+            }
+        }
+        else {
+            auto* frame = static_cast<Frame*>(node.ptr);
+            VisitFrame(frame->prev_, visit);
+            for (const auto& obj : frame->slots_) {
+                VisitObject(obj, visit);
+            }
+        }
+    }
+
+    static std::shared_ptr<void> Share(const Node& node) {
+        if (node.kind == Kind::CELL) {
+            return static_cast<Cell*>(node.ptr)->shared_from_this();
+        }
+        else if (node.kind == Kind::LAMBDA) {
+            return static_cast<Lambda*>(node.ptr)->shared_from_this();
+        }
+        else if (node.kind == Kind::VECTOR) {
+            return static_cast<Vector*>(node.ptr)->shared_from_this();
+        }
+        return static_cast<Frame*>(node.ptr)->shared_from_this();
+    }
+
+    static void Clear(const Node& node) {
+        if (node.kind == Kind::CELL) {
+            auto* cell = static_cast<Cell*>(node.ptr);
+            cell->first_.reset();
+            cell->second_.reset();
+        }
+        else if (node.kind == Kind::LAMBDA) {
+            static_cast<Lambda*>(node.ptr)->frame_.reset();
+        }
+        else if (node.kind == Kind::VECTOR) {
+            static_cast<Vector*>(node.ptr)->elements_.clear();
+        }
+        else {
+            auto* frame = static_cast<Frame*>(node.ptr);
+            frame->prev_.reset();
+            frame->slots_.clear();
+        }
+    }
+
+    std::vector<Node> nodes_;
+};
+
+CollectStats CollectCycles() {
+    return Collector().Collect();
+}
+
+size_t CountNodes() {
+    return Linked<Cell>::Count() + Linked<Lambda>::Count() + Linked<Frame>::Count() +
+           Linked<Vector>::Count();
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <object.h>
+
+#include <cstddef>
+
+struct CollectStats {
+    // cells, lambdas, frames and vectors alive before the collection
+    size_t nodes;
+    size_t freed;
+};
+
+// Frees cells, lambdas, frames and vectors that are reachable only from each other, e.g. a
+// list made circular with set-cdr! and then dropped, or a closure stored in the frame it
+// captured.
+//
+// Ownership stays with shared pointers, the collector only finds the garbage cycles. The
+// roots are the nodes referenced from outside the node graph: the interpreter's globals,
+// the locals of evaluation in progress and anything the embedding code holds. They are
+// found by counting the references between nodes and comparing with the reference counts,
+// so no root has to be registered. Cycles are then broken by clearing the references of
+// every unreachable node, and reference counting frees them.
+CollectStats CollectCycles();
+
+// Number of live cells, lambdas, frames and vectors.
+size_t CountNodes();
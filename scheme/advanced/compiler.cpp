@@ -0,0 +1,806 @@
+#include <compiler.h>
+#include <cell_pool.h>
+#include <error.h>
+#include <vm.h>
+
+#include <algorithm>
+#include <array>
+#include <optional>
+#include <unordered_map>
+
+namespace {
+
+bool IsFalse(const std::shared_ptr<Object>& obj) {
+    return Is<Symbol>(obj) && static_cast<Symbol*>(obj.get())->GetId() == kFalseSymbol;
+}
+
+// Evaluated arguments of a call, on the stack unless there are many of them.
+class ArgumentBuffer {
+public:
+    ArgumentBuffer(const std::vector<NodePtr>& nodes, const std::shared_ptr<Frame>& frame)
+        : data_(inline_.data()), size_(nodes.size()) {
+        if (size_ > kInlineArguments) {
+            heap_.resize(size_);
+            data_ = heap_.data();
+        }
+        for (size_t i = 0; i < size_; ++i) {
+            data_[i] = nodes[i]->Eval(frame);
+        }
+    }
+
+    Arguments Get() const {
+        return {data_, size_};
+    }
+
+private:
+    static constexpr size_t kInlineArguments = 4;
+
+    std::array<std::shared_ptr<Object>, kInlineArguments> inline_;
+    std::vector<std::shared_ptr<Object>> heap_;
+    std::shared_ptr<Object>* data_;
+    size_t size_;
+};
+
+// Stores a call of a closure in call, calls anything else right away.
+std::shared_ptr<Object> CallInTail(std::shared_ptr<Object> function, Arguments args,
+                                   TailCall* call) {
+    if (!Is<Lambda>(function)) {
+        return Apply(function, args);
+    }
+    call->frame = MakeFrame(*static_cast<Lambda*>(function.get()), args);
+    call->closure = std::move(function);
+    return nullptr;
+}
+
+// A copy of a constant from a parsed form that does not share its memory. The parser
+// allocates forms in an arena (see Interpreter::Parse), which any node kept by the program,
+// e.g. a quoted list stored by define, would keep alive whole. Lists are copied without
+// recursion, so they may be of any length and depth.
+std::shared_ptr<Object> CopyConstant(const std::shared_ptr<Object>& value) {
+    if (Is<Number>(value)) {
+        return MakeNumber(static_cast<Number*>(value.get())->GetValue());
+    }
+    if (!Is<Cell>(value)) {
+        // symbols are shared, big numbers are never in an arena
+        return value;
+    }
+    std::vector<std::pair<const Cell*, Cell*>> pending;
+    auto copy_part = [&pending](const std::shared_ptr<Object>& part) -> std::shared_ptr<Object> {
+        if (!Is<Cell>(part)) {
+            return CopyConstant(part);
+        }
+        auto cell = MakeCell(nullptr, nullptr);
+        pending.emplace_back(static_cast<Cell*>(part.get()), cell.get());
+        return cell;
+    };
+    auto copy = copy_part(value);
+    while (!pending.empty()) {
+        auto [from, to] = pending.back();
+        pending.pop_back();
+        to->SetFirst(copy_part(from->GetFirst()));
+        to->SetSecond(copy_part(from->GetSecond()));
+    }
+    return copy;
+}
+
+class ConstantNode : public Node {
+public:
+    explicit ConstantNode(std::shared_ptr<Object> value) : value_(std::move(value)) {
+    }
+
+    std::shared_ptr<Object> Eval(const std::shared_ptr<Frame>&) override {
+        return value_;
+    }
+
+    void Emit(Chunk* chunk, bool) override {
+        chunk->Emit(Opcode::kConstant, chunk->AddConstant(value_));
+    }
+
+private:
+    std::shared_ptr<Object> value_;
+};
+
+class GlobalVariableNode : public Node {
+public:
+    explicit GlobalVariableNode(SymbolId name) : name_(name) {
+    }
+
+    std::shared_ptr<Object> Eval(const std::shared_ptr<Frame>&) override {
+        return LookUpGlobal(name_);
+    }
+
+    void Emit(Chunk* chunk, bool) override {
+        chunk->Emit(Opcode::kLoadGlobal, name_);
+    }
+
+private:
+    SymbolId name_;
+};
+
+// The slot of an internal definition is checked, it is unassigned until the definition runs.
+class LocalVariableNode : public Node {
+public:
+    LocalVariableNode(SymbolId name, Address address, bool checked)
+        : name_(name), address_(address), checked_(checked) {
+    }
+
+    std::shared_ptr<Object> Eval(const std::shared_ptr<Frame>& frame) override {
+        const auto& value = OuterFrame(frame.get(), address_.depth)->slots_[address_.index];
+        if (checked_ && value == Unassigned()) {
+            throw NameError("No such variable: " + GetSymbolName(name_));
+        }
+        return value;
+    }
+
+    void Emit(Chunk* chunk, bool) override {
+        if (checked_) {
+            chunk->Emit(Opcode::kLoadChecked, chunk->AddLocal({address_, name_}));
+        }
+        else {
+            chunk->Emit(Opcode::kLoadLocal, address_);
+        }
+    }
+
+private:
+    SymbolId name_;
+    Address address_;
+    bool checked_;
+};
+
+class GlobalDefineNode : public Node {
+public:
+    GlobalDefineNode(SymbolId name, NodePtr value) : name_(name), value_(std::move(value)) {
+    }
+
+    std::shared_ptr<Object> Eval(const std::shared_ptr<Frame>& frame) override {
+        auto value = value_->Eval(frame);
+        DefineGlobal(name_, std::move(value));
+        return MakeSymbol(kDefineSymbol);
+    }
+
+    void Emit(Chunk* chunk, bool) override {
+        value_->Emit(chunk, false);
+        chunk->Emit(Opcode::kDefineGlobal, name_);
+    }
+
+private:
+    SymbolId name_;
+    NodePtr value_;
+};
+
+// An internal definition, always in the frame of the lambda around it.
+class LocalDefineNode : public Node {
+public:
+    LocalDefineNode(uint32_t index, NodePtr value) : index_(index), value_(std::move(value)) {
+    }
+
+    std::shared_ptr<Object> Eval(const std::shared_ptr<Frame>& frame) override {
+        auto value = value_->Eval(frame);
+        frame->slots_[index_] = std::move(value);
+        return MakeSymbol(kDefineSymbol);
+    }
+
+    void Emit(Chunk* chunk, bool) override {
+        value_->Emit(chunk, false);
+        chunk->Emit(Opcode::kDefineLocal, Address{0, index_});
+    }
+
+private:
+    uint32_t index_;
+    NodePtr value_;
+};
+
+class GlobalSetNode : public Node {
+public:
+    GlobalSetNode(SymbolId name, NodePtr value) : name_(name), value_(std::move(value)) {
+    }
+
+    std::shared_ptr<Object> Eval(const std::shared_ptr<Frame>& frame) override {
+        if (!globals.count(name_)) {
+            throw NameError("No such variable: " + GetSymbolName(name_));
+        }
+        // the entry is looked up again, the value may define globals and move it
+        auto value = value_->Eval(frame);
+        globals[name_] = std::move(value);
+        return nullptr;
+    }
+
+    void Emit(Chunk* chunk, bool) override {
+        value_->Emit(chunk, false);
+        chunk->Emit(Opcode::kSetGlobal, name_);
+    }
+
+private:
+    SymbolId name_;
+    NodePtr value_;
+};
+
+class LocalSetNode : public Node {
+public:
+    LocalSetNode(SymbolId name, Address address, bool checked, NodePtr value)
+        : name_(name), address_(address), checked_(checked), value_(std::move(value)) {
+    }
+
+    std::shared_ptr<Object> Eval(const std::shared_ptr<Frame>& frame) override {
+        auto& slot = OuterFrame(frame.get(), address_.depth)->slots_[address_.index];
+        if (checked_ && slot == Unassigned()) {
+            throw NameError("No such variable: " + GetSymbolName(name_));
+        }
+        // frames never move, the slot stays valid
+        slot = value_->Eval(frame);
+        return nullptr;
+    }
+
+    void Emit(Chunk* chunk, bool) override {
+        value_->Emit(chunk, false);
+        if (checked_) {
+            chunk->Emit(Opcode::kSetChecked, chunk->AddLocal({address_, name_}));
+        }
+        else {
+            chunk->Emit(Opcode::kSetLocal, address_);
+        }
+    }
+
+private:
+    SymbolId name_;
+    Address address_;
+    bool checked_;
+    NodePtr value_;
+};
+
+class IfNode : public Node {
+public:
+    IfNode(NodePtr condition, NodePtr then, NodePtr otherwise)
+        : condition_(std::move(condition)), then_(std::move(then)), else_(std::move(otherwise)) {
+    }
+
+    std::shared_ptr<Object> Eval(const std::shared_ptr<Frame>& frame) override {
+        Node* branch = Choose(condition_->Eval(frame));
+        return branch ? branch->Eval(frame) : nullptr;
+    }
+
+    std::shared_ptr<Object> EvalTail(const std::shared_ptr<Frame>& frame, TailCall* call) override {
+        Node* branch = Choose(condition_->Eval(frame));
+        return branch ? branch->EvalTail(frame, call) : nullptr;
+    }
+
+    void Emit(Chunk* chunk, bool tail) override {
+        condition_->Emit(chunk, false);
+        uint32_t to_else = chunk->Emit(Opcode::kJumpIfFalse);
+        then_->Emit(chunk, tail);
+        uint32_t to_end = chunk->Emit(Opcode::kJump);
+        chunk->PatchJump(to_else);
+        if (else_) {
+            else_->Emit(chunk, tail);
+        }
+        else {
+            chunk->Emit(Opcode::kConstant, chunk->AddConstant(nullptr));
+        }
+        chunk->PatchJump(to_end);
+    }
+
+private:
+    // The branch to evaluate, nullptr for a missing else.
+    Node* Choose(const std::shared_ptr<Object>& condition) const {
+        if (Is<Symbol>(condition)) {
+            SymbolId id = static_cast<Symbol*>(condition.get())->GetId();
+            if (id == kTrueSymbol) {
+                return then_.get();
+            }
+            if (id == kFalseSymbol) {
+                return else_.get();
+            }
+        }
+        throw SyntaxError("Wrong condition type in if");
+    }
+
+    NodePtr condition_;
+    NodePtr then_;
+    NodePtr else_;
+};
+
+// Returns the first false value, or the last value if there is none.
+class AndNode : public Node {
+public:
+    explicit AndNode(std::vector<NodePtr> parts) : parts_(std::move(parts)) {
+    }
+
+    std::shared_ptr<Object> Eval(const std::shared_ptr<Frame>& frame) override {
+        auto ret = MakeBoolean(true);
+        for (const auto& part : parts_) {
+            ret = part->Eval(frame);
+            if (IsFalse(ret)) {
+                break;
+            }
+        }
+        return ret;
+    }
+
+    std::shared_ptr<Object> EvalTail(const std::shared_ptr<Frame>& frame, TailCall* call) override {
+        if (parts_.empty()) {
+            return MakeBoolean(true);
+        }
+        for (size_t i = 0; i + 1 < parts_.size(); ++i) {
+            auto ret = parts_[i]->Eval(frame);
+            if (IsFalse(ret)) {
+                return ret;
+            }
+        }
+        return parts_.back()->EvalTail(frame, call);
+    }
+
+    void Emit(Chunk* chunk, bool tail) override {
+        if (parts_.empty()) {
+            chunk->Emit(Opcode::kConstant, chunk->AddConstant(MakeBoolean(true)));
+            return;
+        }
+        std::vector<uint32_t> to_end;
+        for (size_t i = 0; i + 1 < parts_.size(); ++i) {
+            parts_[i]->Emit(chunk, false);
+            to_end.push_back(chunk->Emit(Opcode::kBranchFalse));
+        }
+        parts_.back()->Emit(chunk, tail);
+        for (uint32_t jump : to_end) {
+            chunk->PatchJump(jump);
+        }
+    }
+
+private:
+    std::vector<NodePtr> parts_;
+};
+
+// Returns the first true value, or the last value if there is none.
+class OrNode : public Node {
+public:
+    explicit OrNode(std::vector<NodePtr> parts) : parts_(std::move(parts)) {
+    }
+
+    std::shared_ptr<Object> Eval(const std::shared_ptr<Frame>& frame) override {
+        auto ret = MakeBoolean(false);
+        for (const auto& part : parts_) {
+            ret = part->Eval(frame);
+            if (!IsFalse(ret)) {
+                break;
+            }
+        }
+        return ret;
+    }
+
+    std::shared_ptr<Object> EvalTail(const std::shared_ptr<Frame>& frame, TailCall* call) override {
+        if (parts_.empty()) {
+            return MakeBoolean(false);
+        }
+        for (size_t i = 0; i + 1 < parts_.size(); ++i) {
+            auto ret = parts_[i]->Eval(frame);
+            if (!IsFalse(ret)) {
+                return ret;
+            }
+        }
+        return parts_.back()->EvalTail(frame, call);
+    }
+
+    void Emit(Chunk* chunk, bool tail) override {
+        if (parts_.empty()) {
+            chunk->Emit(Opcode::kConstant, chunk->AddConstant(MakeBoolean(false)));
+            return;
+        }
+        std::vector<uint32_t> to_end;
+        for (size_t i = 0; i + 1 < parts_.size(); ++i) {
+            parts_[i]->Emit(chunk, false);
+            to_end.push_back(chunk->Emit(Opcode::kBranchTrue));
+        }
+        parts_.back()->Emit(chunk, tail);
+        for (uint32_t jump : to_end) {
+            chunk->PatchJump(jump);
+        }
+    }
+
+private:
+    std::vector<NodePtr> parts_;
+};
+
+class LambdaNode : public Node {
+public:
+    explicit LambdaNode(std::shared_ptr<LambdaCode> code) : code_(std::move(code)) {
+    }
+
+    std::shared_ptr<Object> Eval(const std::shared_ptr<Frame>& frame) override {
+        return std::allocate_shared<Lambda>(PoolAllocator<Lambda>(), code_, frame);
+    }
+
+    void Emit(Chunk* chunk, bool) override {
+        if (!code_->chunk) {
+            code_->chunk = CompileBody(*code_);
+        }
+        chunk->Emit(Opcode::kClosure, chunk->AddLambda(code_));
+    }
+
+private:
+    std::shared_ptr<LambdaCode> code_;
+};
+
+// A call of a builtin that was not shadowed when the call was compiled.
+class BuiltinCallNode : public Node {
+public:
+    BuiltinCallNode(SymbolId name, Function* function, std::vector<NodePtr> args)
+        : name_(name),
+          function_(function),
+          redefinitions_(builtin_redefinitions),
+          args_(std::move(args)) {
+    }
+
+    std::shared_ptr<Object> Eval(const std::shared_ptr<Frame>& frame) override {
+        ArgumentBuffer args(args_, frame);
+        if (redefinitions_ != builtin_redefinitions) {
+            // some builtin got a global definition since, it may be this one
+            return Apply(LookUpGlobal(name_), args.Get());
+        }
+        return (*function_)(args.Get());
+    }
+
+    std::shared_ptr<Object> EvalTail(const std::shared_ptr<Frame>& frame, TailCall* call) override {
+        ArgumentBuffer args(args_, frame);
+        if (redefinitions_ != builtin_redefinitions) {
+            return CallInTail(LookUpGlobal(name_), args.Get(), call);
+        }
+        return (*function_)(args.Get());
+    }
+
+    void Emit(Chunk* chunk, bool) override {
+        for (const auto& arg : args_) {
+            arg->Emit(chunk, false);
+        }
+        uint32_t argc = args_.size();
+        chunk->Emit(Opcode::kCallBuiltin,
+                    chunk->AddBuiltinCall({name_, function_, redefinitions_, argc}));
+    }
+
+private:
+    SymbolId name_;
+    Function* function_;
+    size_t redefinitions_;
+    std::vector<NodePtr> args_;
+};
+
+class CallNode : public Node {
+public:
+    CallNode(NodePtr function, std::vector<NodePtr> args)
+        : function_(std::move(function)), args_(std::move(args)) {
+    }
+
+    std::shared_ptr<Object> Eval(const std::shared_ptr<Frame>& frame) override {
+        auto function = function_->Eval(frame);
+        ArgumentBuffer args(args_, frame);
+        return Apply(function, args.Get());
+    }
+
+    std::shared_ptr<Object> EvalTail(const std::shared_ptr<Frame>& frame, TailCall* call) override {
+        auto function = function_->Eval(frame);
+        ArgumentBuffer args(args_, frame);
+        return CallInTail(std::move(function), args.Get(), call);
+    }
+
+    void Emit(Chunk* chunk, bool tail) override {
+        function_->Emit(chunk, false);
+        for (const auto& arg : args_) {
+            arg->Emit(chunk, false);
+        }
+        chunk->Emit(tail ? Opcode::kTailCall : Opcode::kCall, args_.size());
+    }
+
+private:
+    NodePtr function_;
+    std::vector<NodePtr> args_;
+};
+
+// Elements of a form, which must be a proper list.
+std::vector<std::shared_ptr<Object>> FormItems(std::shared_ptr<Object> form) {
+    std::vector<std::shared_ptr<Object>> items;
+    while (Is<Cell>(form)) {
+        items.push_back(As<Cell>(form)->GetFirst());
+        form = As<Cell>(form)->GetSecond();
+    }
+    if (form) {
+        throw RuntimeError("Wrong input");
+    }
+    return items;
+}
+
+class Compiler {
+public:
+    NodePtr Compile(const std::shared_ptr<Object>& form) {
+        if (!form) {
+            throw RuntimeError("Empty list can not be evaluated");
+        }
+        if (Is<Symbol>(form)) {
+            SymbolId id = As<Symbol>(form)->GetId();
+            if (id == kTrueSymbol || id == kFalseSymbol) {
+                return std::make_unique<ConstantNode>(form);
+            }
+            bool checked;
+            if (auto address = Resolve(id, &checked)) {
+                return std::make_unique<LocalVariableNode>(id, *address, checked);
+            }
+            return std::make_unique<GlobalVariableNode>(id);
+        }
+        if (!Is<Cell>(form)) {
+            return std::make_unique<ConstantNode>(CopyConstant(form));
+        }
+        if (nesting_ == kMaxNesting) {
+            throw RuntimeError("Too deeply nested expression");
+        }
+        ++nesting_;
+        NodePtr node;
+        try {
+            node = CompileList(FormItems(form));
+        } catch (...) {
+            --nesting_;
+            throw;
+        }
+        --nesting_;
+        return node;
+    }
+
+private:
+    // Compiling, evaluating, emitting and destroying a node recurse into its children on the
+    // native stack, so the depth of a form is bounded here once for all of them. Quoted data
+    // is not compiled and may be nested arbitrarily deep.
+    static constexpr size_t kMaxNesting = 1000;
+
+    NodePtr CompileList(const std::vector<std::shared_ptr<Object>>& items) {
+        static const SymbolId kIf = Intern("if");
+        static const SymbolId kSet = Intern("set!");
+        static const SymbolId kAnd = Intern("and");
+        static const SymbolId kOr = Intern("or");
+
+        if (!items[0]) {
+            throw RuntimeError("No function was typed");
+        }
+        if (Is<Symbol>(items[0])) {
+            SymbolId id = As<Symbol>(items[0])->GetId();
+            if (id == kQuoteSymbol) {
+                if (items.size() != 2) {
+                    throw RuntimeError("Wrong input for quote");
+                }
+                return std::make_unique<ConstantNode>(CopyConstant(items[1]));
+            }
+            if (id == kDefineSymbol) {
+                return CompileDefine(items);
+            }
+            if (id == kLambdaSymbol) {
+                if (items.size() < 3) {
+                    throw SyntaxError("Lambda without a body");
+                }
+                return CompileLambda(items[1], items, 2);
+            }
+            if (id == kIf) {
+                if (items.size() != 3 && items.size() != 4) {
+                    throw SyntaxError("Wrong input in if");
+                }
+                return std::make_unique<IfNode>(Compile(items[1]), Compile(items[2]),
+                                                items.size() == 4 ? Compile(items[3]) : nullptr);
+            }
+            if (id == kSet) {
+                if (items.size() != 3 || !Is<Symbol>(items[1])) {
+                    throw SyntaxError("Wrong syntax in set!");
+                }
+                SymbolId name = As<Symbol>(items[1])->GetId();
+                bool checked;
+                if (auto address = Resolve(name, &checked)) {
+                    return std::make_unique<LocalSetNode>(name, *address, checked,
+                                                          Compile(items[2]));
+                }
+                return std::make_unique<GlobalSetNode>(name, Compile(items[2]));
+            }
+            if (id == kAnd) {
+                return std::make_unique<AndNode>(CompileAll(items, 1));
+            }
+            if (id == kOr) {
+                return std::make_unique<OrNode>(CompileAll(items, 1));
+            }
+            if (!IsShadowed(id)) {
+                if (auto builtin = FindBuiltin(id)) {
+                    return std::make_unique<BuiltinCallNode>(
+                        id, As<Builtin>(builtin)->GetFunction(), CompileAll(items, 1));
+                }
+            }
+        }
+        auto function = Compile(items[0]);
+        return std::make_unique<CallNode>(std::move(function), CompileAll(items, 1));
+    }
+
+    std::vector<NodePtr> CompileAll(const std::vector<std::shared_ptr<Object>>& items,
+                                    size_t begin) {
+        std::vector<NodePtr> nodes;
+        for (size_t i = begin; i < items.size(); ++i) {
+            nodes.push_back(Compile(items[i]));
+        }
+        return nodes;
+    }
+
+    // (define name value) or (define (name params...) body...)
+    NodePtr CompileDefine(const std::vector<std::shared_ptr<Object>>& items) {
+        if (items.size() < 3) {
+            throw SyntaxError("Wrong syntax in define");
+        }
+        std::shared_ptr<Object> target = items[1];
+        if (Is<Cell>(target)) {
+            target = As<Cell>(target)->GetFirst();
+        }
+        if (!Is<Symbol>(target)) {
+            throw SyntaxError("Wrong syntax for variable name");
+        }
+        if (Is<Symbol>(items[1]) && items.size() != 3) {
+            throw SyntaxError("Wrong syntax in define");
+        }
+        SymbolId name = As<Symbol>(target)->GetId();
+        // a definition nested in some other form still defines a local
+        std::optional<uint32_t> slot;
+        if (!frames_.empty()) {
+            slot = frames_.back().AddSlot(name);
+        }
+        // the value may refer to the variable being defined, e.g. a recursive lambda
+        defining_.push_back(name);
+        NodePtr value = Is<Symbol>(items[1])
+                            ? Compile(items[2])
+                            : CompileLambda(As<Cell>(items[1])->GetSecond(), items, 2);
+        defining_.pop_back();
+        if (slot) {
+            return std::make_unique<LocalDefineNode>(*slot, std::move(value));
+        }
+        return std::make_unique<GlobalDefineNode>(name, std::move(value));
+    }
+
+    // The lambda with the parameters and the body items[begin..].
+    NodePtr CompileLambda(const std::shared_ptr<Object>& params,
+                          const std::vector<std::shared_ptr<Object>>& items, size_t begin) {
+        auto code = std::make_shared<LambdaCode>();
+        FrameLayout layout;
+        for (auto rest = params; rest; rest = As<Cell>(rest)->GetSecond()) {
+            if (!Is<Cell>(rest) || !Is<Symbol>(As<Cell>(rest)->GetFirst())) {
+                throw SyntaxError("Wrong lambda parameters");
+            }
+            // a repeated parameter name refers to the last of them
+            layout.slots[As<Symbol>(As<Cell>(rest)->GetFirst())->GetId()] = layout.size++;
+        }
+        layout.params = layout.size;
+        // internal definitions are locals of the whole body, whatever their position
+        for (size_t i = begin; i < items.size(); ++i) {
+            if (auto name = DefinedName(items[i])) {
+                layout.AddSlot(*name);
+            }
+        }
+        frames_.push_back(std::move(layout));
+        for (size_t i = begin; i < items.size(); ++i) {
+            code->body.push_back(Compile(items[i]));
+        }
+        code->params = frames_.back().params;
+        code->frame_size = frames_.back().size;
+        frames_.pop_back();
+        return std::make_unique<LambdaNode>(std::move(code));
+    }
+
+    static std::optional<SymbolId> DefinedName(const std::shared_ptr<Object>& form) {
+        if (!Is<Cell>(form) || !Is<Symbol>(As<Cell>(form)->GetFirst()) ||
+            As<Symbol>(As<Cell>(form)->GetFirst())->GetId() != kDefineSymbol ||
+            !Is<Cell>(As<Cell>(form)->GetSecond())) {
+            return std::nullopt;
+        }
+        auto target = As<Cell>(As<Cell>(form)->GetSecond())->GetFirst();
+        if (Is<Cell>(target)) {
+            target = As<Cell>(target)->GetFirst();
+        }
+        if (!Is<Symbol>(target)) {
+            return std::nullopt;
+        }
+        return As<Symbol>(target)->GetId();
+    }
+
+    // The address of the local variable, nullopt for a global one. Sets checked if the variable
+    // is an internal definition, which may not have been evaluated yet.
+    std::optional<Address> Resolve(SymbolId name, bool* checked) const {
+        for (size_t i = frames_.size(); i > 0; --i) {
+            const FrameLayout& layout = frames_[i - 1];
+            auto it = layout.slots.find(name);
+            if (it != layout.slots.end()) {
+                *checked = it->second >= layout.params;
+                return Address{static_cast<uint32_t>(frames_.size() - i), it->second};
+            }
+        }
+        return std::nullopt;
+    }
+
+    // A builtin is bound at compile time unless a variable has its name.
+    bool IsShadowed(SymbolId name) const {
+        bool checked;
+        return Resolve(name, &checked) || globals.count(name) ||
+               std::find(defining_.begin(), defining_.end(), name) != defining_.end();
+    }
+
+    // The slots of a lambda being compiled.
+    struct FrameLayout {
+        uint32_t AddSlot(SymbolId name) {
+            auto [it, added] = slots.emplace(name, size);
+            if (added) {
+                ++size;
+            }
+            return it->second;
+        }
+
+        std::unordered_map<SymbolId, uint32_t> slots;
+        uint32_t params = 0;
+        uint32_t size = 0;
+    };
+
+    // the lambdas around the form being compiled, innermost last
+    std::vector<FrameLayout> frames_;
+    // the names of the definitions around it
+    std::vector<SymbolId> defining_;
+    // the lists around the form being compiled
+    size_t nesting_ = 0;
+};
+
+}  // namespace
+
+std::shared_ptr<Object> LookUpGlobal(SymbolId name) {
+    auto it = globals.find(name);
+    if (it != globals.end()) {
+        return it->second;
+    }
+    if (auto builtin = FindBuiltin(name)) {
+        return builtin;
+    }
+    throw NameError("No such variable: " + GetSymbolName(name));
+}
+
+void DefineGlobal(SymbolId name, std::shared_ptr<Object> value) {
+    if (FindBuiltin(name)) {
+        ++builtin_redefinitions;
+    }
+    globals[name] = std::move(value);
+}
+
+const std::shared_ptr<Object>& Unassigned() {
+    // no symbol read from a program has a space in its name
+    static const std::shared_ptr<Object> kUnassigned = MakeSymbol(Intern("unassigned variable"));
+    return kUnassigned;
+}
+
+std::shared_ptr<Frame> MakeFrame(const Lambda& lambda, Arguments args) {
+    const LambdaCode& code = lambda.GetCode();
+    if (args.size() != code.params) {
+        throw RuntimeError("Wrong number of arguments");
+    }
+    auto frame = std::allocate_shared<Frame>(PoolAllocator<Frame>(), code.frame_size);
+    frame->prev_ = lambda.GetFrame();
+    std::copy(args.begin(), args.end(), frame->slots_.begin());
+    std::fill(frame->slots_.begin() + args.size(), frame->slots_.end(), Unassigned());
+    return frame;
+}
+
+NodePtr Compile(const std::shared_ptr<Object>& form) {
+    return Compiler().Compile(form);
+}
+
+std::shared_ptr<Object> Apply(const std::shared_ptr<Object>& function, Arguments args) {
+    if (Is<Builtin>(function)) {
+        return (*static_cast<Builtin*>(function.get())->GetFunction())(args);
+    }
+    if (!Is<Lambda>(function)) {
+        throw RuntimeError("Wrong name of function");
+    }
+    TailCall call{function, MakeFrame(*static_cast<Lambda*>(function.get()), args)};
+    // each closure called in tail position runs in place of the one that called it
+    while (true) {
+        auto closure = std::move(call.closure);
+        auto frame = std::move(call.frame);
+        const LambdaCode& code = static_cast<Lambda*>(closure.get())->GetCode();
+        for (size_t i = 0; i + 1 < code.body.size(); ++i) {
+            code.body[i]->Eval(frame);
+        }
+        auto value = code.body.back()->EvalTail(frame, &call);
+        if (!call.closure) {
+            return value;
+        }
+    }
+}
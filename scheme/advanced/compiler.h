@@ -0,0 +1,92 @@
+#pragma once
+
+#include <builtins.h>
+#include <object.h>
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// Programs are compiled before they are evaluated. Compiling a form decides once what every
+// part of it means: special forms become nodes of their own, calls of builtins are bound to
+// the builtin, symbols become variable references and quoted data become constants. The
+// evaluator then only walks the resulting tree of nodes, or runs the bytecode emitted from it.
+//
+// Variables are resolved lexically. The parameters and the internal definitions of a lambda
+// get the slots of its frame, and a reference to a local variable becomes its address: how many
+// frames out it lives and in which slot. Only the variables that no lambda around binds are
+// looked up by name, among the globals.
+
+struct Chunk;
+
+// A call of a closure in tail position, left to the caller by Node::EvalTail.
+struct TailCall {
+    // keeps the code alive while it runs
+    std::shared_ptr<Object> closure;
+    std::shared_ptr<Frame> frame;
+};
+
+// Where a local variable lives: depth frames out from the current one, in the slot index.
+struct Address {
+    uint32_t depth;
+    uint32_t index;
+};
+
+class Node {
+public:
+    virtual ~Node() = default;
+
+    // The frame is nullptr at the top level.
+    virtual std::shared_ptr<Object> Eval(const std::shared_ptr<Frame>& frame) = 0;
+
+    // Evaluates the node in tail position. A call of a closure is not made but stored in call,
+    // which the caller then runs in place of its own, so that loops written as tail calls run
+    // in constant stack. The value is meaningless then.
+    virtual std::shared_ptr<Object> EvalTail(const std::shared_ptr<Frame>& frame, TailCall*) {
+        return Eval(frame);
+    }
+
+    // Appends the code that pushes the value of the node, see vm.h. A node in tail position
+    // is the last thing evaluated by a lambda body.
+    virtual void Emit(Chunk* chunk, bool tail) = 0;
+};
+
+using NodePtr = std::unique_ptr<Node>;
+
+// A lambda expression, shared by all the closures made from it.
+struct LambdaCode {
+    // the parameters take the first slots of the frame, internal definitions the rest
+    uint32_t params;
+    uint32_t frame_size;
+    std::vector<NodePtr> body;
+    // the body on the bytecode machine, emitted along with the code that makes the closures
+    std::shared_ptr<const Chunk> chunk;
+};
+
+// Throws SyntaxError on malformed special forms and RuntimeError on other forms that can not
+// be evaluated. Global variables are looked up only when the code runs.
+NodePtr Compile(const std::shared_ptr<Object>& form);
+
+// The global variable, or the builtin with the name. Throws NameError.
+std::shared_ptr<Object> LookUpGlobal(SymbolId name);
+
+// Counts the definitions that shadow a builtin, see builtin_redefinitions.
+void DefineGlobal(SymbolId name, std::shared_ptr<Object> value);
+
+// The frame depth levels out from the frame.
+inline Frame* OuterFrame(Frame* frame, uint32_t depth) {
+    for (; depth > 0; --depth) {
+        frame = frame->prev_.get();
+    }
+    return frame;
+}
+
+// What the slot of an internal definition holds until the definition is evaluated.
+const std::shared_ptr<Object>& Unassigned();
+
+// A frame for a call of the closure with the arguments. Throws RuntimeError on a wrong number
+// of arguments.
+std::shared_ptr<Frame> MakeFrame(const Lambda& lambda, Arguments args);
+
+// Calls a closure or a builtin.
+std::shared_ptr<Object> Apply(const std::shared_ptr<Object>& function, Arguments args);
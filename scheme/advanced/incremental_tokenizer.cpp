@@ -0,0 +1,152 @@
+#include <incremental_tokenizer.h>
+#include <error.h>
+#include <char_class.h>
+
+IncrementalTokenizer::IncrementalTokenizer()
+    : state_(State::IDLE), number_(0), negative_(false), head_(0) {
+}
+
+void IncrementalTokenizer::Feed(std::string_view chunk) {
+    size_t pos = 0;
+    while (pos < chunk.size()) {
+        char curr = chunk[pos];
+        if (state_ == State::IDLE) {
+            pos = FeedIdle(chunk, pos);
+        }
+        else if (state_ == State::SIGN) {
+            if (HasCharClass(curr, kDigitClass)) {
+                negative_ = pending_[0] == '-';
+                number_ = 0;
+                state_ = State::NUMBER;
+            }
+            else {
+                EmitSymbol();
+            }
+        }
+        else if (state_ == State::NUMBER || state_ == State::BIG_NUMBER) {
+            while (pos < chunk.size() && HasCharClass(chunk[pos], kDigitClass)) {
+                if (state_ == State::BIG_NUMBER) {
+                    pending_.push_back(chunk[pos]);
+                }
+                else if (!AppendDigit(&number_, chunk[pos] - '0', negative_)) {
+                    pending_ = std::to_string(number_);
+                    pending_.push_back(chunk[pos]);
+                    state_ = State::BIG_NUMBER;
+                }
+                ++pos;
+            }
+            if (pos < chunk.size()) {
+                EmitNumber();
+            }
+        }
+        else {
+            size_t end = pos;
+            while (end < chunk.size() && HasCharClass(chunk[end], kSymbolClass)) {
+                ++end;
+            }
+            pending_.append(chunk.substr(pos, end - pos));
+            pos = end;
+            if (pos < chunk.size()) {
+                if (!HasCharClass(chunk[pos], kSpaceClass) && chunk[pos] != ')') {
+                    Fail("Unresolved mid character");
+                }
+                EmitSymbol();
+            }
+        }
+    }
+}
+
+void IncrementalTokenizer::Finish() {
+    if (state_ == State::NUMBER || state_ == State::BIG_NUMBER) {
+        EmitNumber();
+    }
+    else if (state_ == State::SIGN || state_ == State::SYMBOL) {
+        EmitSymbol();
+    }
+}
+
+bool IncrementalTokenizer::IsEnd() const {
+    return head_ == ready_.size();
+}
+
+void IncrementalTokenizer::Next() {
+    ++head_;
+    if (head_ == ready_.size()) {
+        ready_.clear();
+        head_ = 0;
+    }
+}
+
+const Token& IncrementalTokenizer::GetToken() const {
+    return ready_[head_];
+}
+
+std::vector<Token> IncrementalTokenizer::TakeTokens() {
+    std::vector<Token> ret(ready_.begin() + head_, ready_.end());
+    ready_.clear();
+    head_ = 0;
+    return ret;
+}
+
+// Starts a new token at chunk[pos], returns the position after the consumed characters.
+size_t IncrementalTokenizer::FeedIdle(std::string_view chunk, size_t pos) {
+    char curr = chunk[pos];
+    if (HasCharClass(curr, kSpaceClass)) {
+        return pos + 1;
+    }
+    if (curr == '(') {
+        Emit(BracketToken::OPEN);
+    }
+    else if (curr == ')') {
+        Emit(BracketToken::CLOSE);
+    }
+    else if (curr == '\'') {
+        Emit(QuoteToken());
+    }
+    else if (curr == '.') {
+        Emit(DotToken());
+    }
+    else if (HasCharClass(curr, kDigitClass)) {
+        negative_ = false;
+        number_ = 0;
+        state_ = State::NUMBER;
+        return pos;
+    }
+    else if (curr == '+' || curr == '-') {
+        pending_.assign(1, curr);
+        state_ = State::SIGN;
+    }
+    else if (HasCharClass(curr, kSymbolStartClass)) {
+        pending_.clear();
+        state_ = State::SYMBOL;
+        return pos;
+    }
+    else {
+        Fail("Unresolved start character");
+    }
+    return pos + 1;
+}
+
+void IncrementalTokenizer::Emit(const Token& token) {
+    ready_.push_back(token);
+    state_ = State::IDLE;
+}
+
+void IncrementalTokenizer::EmitSymbol() {
+    Emit(SymbolToken(pending_));
+}
+
+void IncrementalTokenizer::EmitNumber() {
+    if (state_ == State::BIG_NUMBER) {
+        Emit(BigNumberToken(pending_));
+    }
+    else {
+        Emit(ConstantToken(number_));
+    }
+}
+
+void IncrementalTokenizer::Fail(const std::string& message) {
+    state_ = State::IDLE;
+    pending_.clear();
+    throw SyntaxError(message);
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <tokenizer.h>
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Tokenizer for input that arrives in chunks of arbitrary size. Feed() consumes only the new
+// bytes: a symbol or number cut by a chunk boundary is kept as state and completed by the next
+// chunk. Complete tokens are read with IsEnd/GetToken/Next like with Tokenizer.
+//
+// Tokens may be collected and replayed through Tokenizer{tokens} to Read them.
+class IncrementalTokenizer {
+public:
+    IncrementalTokenizer();
+
+    // On SyntaxError the rest of the chunk is dropped and the tokenizer starts from scratch.
+    void Feed(std::string_view chunk);
+
+    // Marks the end of input, completes a pending symbol or number.
+    void Finish();
+
+    // True when there is no complete token to read yet.
+    bool IsEnd() const;
+
+    void Next();
+
+    const Token& GetToken() const;
+
+    // Moves out every complete token that was not read yet.
+    std::vector<Token> TakeTokens();
+
+private:
+    // BIG_NUMBER keeps the digits in pending_ once they do not fit into number_
+    enum class State { IDLE, SIGN, NUMBER, BIG_NUMBER, SYMBOL };
+
+    size_t FeedIdle(std::string_view chunk, size_t pos);
+
+    void Emit(const Token& token);
+
+    void EmitSymbol();
+
+    void EmitNumber();
+
+    void Fail(const std::string& message);
+
+    State state_;
+    int64_t number_;
+    bool negative_;
+    std::string pending_;
+    std::vector<Token> ready_;
+    size_t head_;
+};
@@ -0,0 +1,41 @@
+#include <mapped_file.h>
+#include <error.h>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+MappedFile::MappedFile(const std::string& path) : data_(nullptr), size_(0) {
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd == -1) {
+        throw RuntimeError("Cannot open file: " + path);
+    }
+    struct stat st;
+    if (fstat(fd, &st) == -1) {
+        close(fd);
+        throw RuntimeError("Cannot stat file: " + path);
+    }
+    size_ = st.st_size;
+    // mmap refuses empty mappings, an empty file is just an empty view
+    if (size_ != 0) {
+        void* addr = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (addr == MAP_FAILED) {
+            close(fd);
+            throw RuntimeError("Cannot map file: " + path);
+        }
+        madvise(addr, size_, MADV_SEQUENTIAL);
+        data_ = static_cast<const char*>(addr);
+    }
+    close(fd);
+}
+
+MappedFile::~MappedFile() {
+    if (data_) {
+        munmap(const_cast<char*>(data_), size_);
+    }
+}
+
+std::string_view MappedFile::View() const {
+    return std::string_view(data_, size_);
+}
@@ -0,0 +1,22 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+
+// Read-only memory mapping of a whole file, meant to be tokenized in place:
+// Tokenizer tokenizer{file.View()};
+class MappedFile {
+public:
+    MappedFile(const std::string& path);
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    ~MappedFile();
+
+    std::string_view View() const;
+
+private:
+    const char* data_;
+    size_t size_;
+};
@@ -1,10 +1,93 @@
 #include <object.h>
+#include <cell_pool.h>
+#include <compiler.h>
+#include <error.h>
+
+#include <deque>
+#include <unordered_set>
+#include <vector>
+
+namespace {
+
+// Prints lists and vectors. Like the destructor of Cell, walks the spine of a list in place; the
+// parts still to print wait on the stack, either an object or the text before it. A list prints
+// without its parentheses, the caller adds them.
+std::string Print(Object* root) {
+    struct Part {
+        Object* obj;
+        const char* text;
+        // the vector whose elements are all printed
+        Vector* closed;
+    };
+    std::string ret;
+    std::vector<Part> parts = {{root, nullptr, nullptr}};
+    // the vectors being printed, a vector among its own elements is a cycle
+    std::unordered_set<Vector*> open;
+    while (!parts.empty()) {
+        Part part = parts.back();
+        parts.pop_back();
+        if (part.text) {
+            ret += part.text;
+        }
+        else if (part.closed) {
+            open.erase(part.closed);
+        }
+        else if (part.obj->GetType() == TypeObject::CELL) {
+            auto* cell = static_cast<Cell*>(part.obj);
+            if (!cell->GetFirst()) {
+                ret += "()";
+                continue;
+            }
+            if (cell->GetSecond()) {
+                parts.push_back({cell->GetSecond().get(), nullptr, nullptr});
+                parts.push_back({nullptr, Is<Cell>(cell->GetSecond()) ? " " : " . ", nullptr});
+            }
+            parts.push_back({cell->GetFirst().get(), nullptr, nullptr});
+        }
+        else if (part.obj->GetType() == TypeObject::VECTOR) {
+            auto* vector = static_cast<Vector*>(part.obj);
+            if (!open.insert(vector).second) {
+                throw RuntimeError("Can not print a vector that contains itself");
+            }
+            parts.push_back({nullptr, nullptr, vector});
+            parts.push_back({nullptr, ")", nullptr});
+            const auto& elements = vector->GetElements();
+            for (size_t i = elements.size(); i > 0; --i) {
+                const auto& element = elements[i - 1];
+                if (!element) {
+                    parts.push_back({nullptr, "()", nullptr});
+                }
+                else if (Is<Cell>(element)) {
+                    parts.push_back({nullptr, ")", nullptr});
+                    parts.push_back({element.get(), nullptr, nullptr});
+                    parts.push_back({nullptr, "(", nullptr});
+                }
+                else {
+                    parts.push_back({element.get(), nullptr, nullptr});
+                }
+                if (i > 1) {
+                    parts.push_back({nullptr, " ", nullptr});
+                }
+            }
+            parts.push_back({nullptr, "#(", nullptr});
+        }
+        else {
+            ret += part.obj->ToString();
+        }
+    }
+    return ret;
+}
+
+}  // namespace
 
 // Number
-Number::Number(int val) : val_(val) {
+Number::Number() : Object(kType), val_(0) {
 }
 
-int Number::GetValue() const {
+Number::Number(int64_t val) : Object(kType), val_(val) {
+}
+
+int64_t Number::GetValue() const {
     return val_;
 }
 
@@ -12,64 +95,157 @@ std::string Number::ToString() {
     return std::to_string(GetValue());
 }
 
-TypeObject Number::GetType() {
-    return TypeObject::NUMBER;
-}
-
 std::shared_ptr<Object> Number::Clone() {
     return std::make_shared<Number>(val_);
 }
 
+std::shared_ptr<Object> MakeNumber(int64_t value) {
+    static std::vector<Number> cached = [] {
+        std::vector<Number> numbers;
+        numbers.reserve(kMaxCachedNumber - kMinCachedNumber + 1);
+        for (int i = kMinCachedNumber; i <= kMaxCachedNumber; ++i) {
+            numbers.emplace_back(i);
+            numbers.back().immortal_ = true;
+        }
+        return numbers;
+    }();
+    if (!IsCachedNumber(value)) {
+        return std::make_shared<Number>(value);
+    }
+    return cached[value - kMinCachedNumber].Self();
+}
+
+std::shared_ptr<Object> MakeNumber(BigInt value) {
+    if (value.FitsInt64()) {
+        return MakeNumber(value.ToInt64());
+    }
+    return std::make_shared<BigNumber>(std::move(value));
+}
+
+// BigNumber
+BigNumber::BigNumber(BigInt val) : Object(kType), val_(std::move(val)) {
+}
+
+std::shared_ptr<Object> BigNumber::Execute() {
+    return Self();
+}
+
+std::string BigNumber::ToString() {
+    return val_.ToString();
+}
+
+std::shared_ptr<Object> BigNumber::Clone() {
+    return std::make_shared<BigNumber>(val_);
+}
+
+const BigInt& BigNumber::GetValue() const {
+    return val_;
+}
+
 // Symbol
-Symbol::Symbol(const std::string& val) : val_(val) {
+Symbol::Symbol() : Object(kType), id_(kDotSymbol) {
+}
+
+Symbol::Symbol(const std::string& val) : Object(kType), id_(Intern(val)) {
+}
+
+Symbol::Symbol(SymbolId id) : Object(kType), id_(id) {
 }
 
 const std::string& Symbol::GetName() const {
-    return val_;
+    return GetSymbolName(id_);
+}
+
+SymbolId Symbol::GetId() const {
+    return id_;
 }
 
 std::string Symbol::ToString() {
     return GetName();
 }
 
-TypeObject Symbol::GetType() {
-    return TypeObject::SYMBOL;
+std::shared_ptr<Object> Symbol::Clone() {
+    return MakeSymbol(id_);
 }
 
-std::shared_ptr<Object> Symbol::Clone() {
-    return std::make_shared<Symbol>(val_);
+std::shared_ptr<Object> MakeSymbol(SymbolId id) {
+    // grows with the symbol table, deque keeps the objects in place
+    static std::deque<Symbol> cached;
+    while (cached.size() <= id) {
+        cached.emplace_back(static_cast<SymbolId>(cached.size()));
+        cached.back().immortal_ = true;
+    }
+    return cached[id].Self();
+}
+
+std::shared_ptr<Object> MakeBoolean(bool value) {
+    return MakeSymbol(value ? kTrueSymbol : kFalseSymbol);
 }
 
 // Cell
+Cell::Cell() : Object(kType) {
+}
+
 Cell::Cell(const std::shared_ptr<Object>& first, const std::shared_ptr<Object>& second)
-    : first_(first), second_(second) {
+    : Object(kType), first_(first), second_(second) {
 }
 
-std::string Cell::ToString() {
-    if (!GetFirst()) {
-        return "()";
+namespace {
+
+// A list or a vector that dies together with the pointer.
+bool IsOwnedContainer(const std::shared_ptr<Object>& obj) {
+    return (Is<Cell>(obj) || Is<Vector>(obj)) && obj.use_count() == 1;
+}
+
+}  // namespace
+
+Cell::~Cell() {
+    if (!IsOwnedContainer(first_) && !IsOwnedContainer(second_)) {
+        return;
     }
-    if (!GetSecond()) {
-        return GetFirst()->ToString();
-    } else if (GetSecond()->GetType() != TypeObject::CELL) {
-        return GetFirst()->ToString() + " . " + GetSecond()->ToString();
-    } else {
-        return GetFirst()->ToString() + " " + GetSecond()->ToString();
+    std::vector<std::shared_ptr<Object>> nested;
+    nested.push_back(std::move(first_));
+    nested.push_back(std::move(second_));
+    ReleaseNested(std::move(nested));
+}
+
+void Cell::ReleaseNested(std::vector<std::shared_ptr<Object>> nested) {
+    // Owned lists and vectors are taken out of their parents before the parents die, so every
+    // destructor below returns right away. The spine of a list is walked in place, only nested
+    // lists and elements of vectors wait on the stack.
+    while (!nested.empty()) {
+        std::shared_ptr<Object> obj = std::move(nested.back());
+        nested.pop_back();
+        while (IsOwnedContainer(obj)) {
+            if (Is<Vector>(obj)) {
+                for (auto& element : static_cast<Vector*>(obj.get())->GetElements()) {
+                    if (IsOwnedContainer(element)) {
+                        nested.push_back(std::move(element));
+                    }
+                }
+                break;
+            }
+            auto* cell = static_cast<Cell*>(obj.get());
+            if (IsOwnedContainer(cell->first_)) {
+                nested.push_back(std::move(cell->first_));
+            }
+            obj = std::move(cell->second_);
+        }
     }
 }
 
-TypeObject Cell::GetType() {
-    return TypeObject::CELL;
+std::string Cell::ToString() {
+    return Print(this);
 }
 
 std::shared_ptr<Object> Cell::Clone() {
-    return std::make_shared<Cell>(first_, second_);
+    return MakeCell(first_, second_);
 }
 
-std::shared_ptr<Object> Cell::GetFirst() const {
+const std::shared_ptr<Object>& Cell::GetFirst() const {
     return first_;
 }
-std::shared_ptr<Object> Cell::GetSecond() const {
+const std::shared_ptr<Object>& Cell::GetSecond() const {
     return second_;
 }
 
@@ -81,26 +257,47 @@ void Cell::SetSecond(std::shared_ptr<Object> val) {
     second_ = val;
 }
 
-//lambda
+// Vector
+Vector::Vector() : Object(kType) {
+}
+
+Vector::Vector(std::vector<std::shared_ptr<Object>> elements)
+    : Object(kType), elements_(std::move(elements)) {
+}
+
+Vector::~Vector() {
+    for (const auto& element : elements_) {
+        if (IsOwnedContainer(element)) {
+            Cell::ReleaseNested(std::move(elements_));
+            return;
+        }
+    }
+}
+
+std::shared_ptr<Object> Vector::Execute() {
+    return Self();
+}
 
-Lambda::Lambda() {
-    scope_ = std::make_shared<Scope>();
-    scope_->prev_ = curr;
+std::string Vector::ToString() {
+    return Print(this);
 }
 
-Lambda::Lambda(const std::vector<std::shared_ptr<Object>>& body, const std::vector<std::string>& vars) {
-    body_ = body;
-    l_vars_ = vars;
+std::shared_ptr<Object> Vector::Clone() {
+    return std::make_shared<Vector>(elements_);
+}
+
+std::vector<std::shared_ptr<Object>>& Vector::GetElements() {
+    return elements_;
+}
+
+//lambda
+
+Lambda::Lambda(std::shared_ptr<const LambdaCode> code, std::shared_ptr<Frame> frame)
+    : Object(kType), code_(std::move(code)), frame_(std::move(frame)) {
 }
 
 std::shared_ptr<Object> Lambda::Execute() {
-    curr = scope_;
-    for (size_t i = 0; i < body_.size() - 1; ++i) {
-        body_[i]->Execute();
-    }
-    auto ret = body_.back()->Execute();
-    curr = curr->prev_;
-    return ret;
+    return Self();
 }
 
 //,       ToString()
@@ -109,20 +306,34 @@ std::string Lambda::ToString() {
     return "";
 }
 
-//       ,      
-TypeObject Lambda::GetType() {
-    return TypeObject::LAMBDA;
+std::shared_ptr<Object> Lambda::Clone() {
+    return std::make_shared<Lambda>(code_, frame_);
 }
 
-// GetType()
-std::shared_ptr<Object> Lambda::Clone() {
-    return std::make_shared<Lambda>();
+const LambdaCode& Lambda::GetCode() const {
+    return *code_;
+}
+
+const std::shared_ptr<Frame>& Lambda::GetFrame() const {
+    return frame_;
+}
+
+// Builtin
+Builtin::Builtin(std::shared_ptr<Function> function) : Object(kType), function_(std::move(function)) {
+}
+
+std::shared_ptr<Object> Builtin::Execute() {
+    return Self();
+}
+
+std::string Builtin::ToString() {
+    return "";
 }
 
-std::vector<std::string>& Lambda::GetVars() {
-    return l_vars_;
+std::shared_ptr<Object> Builtin::Clone() {
+    return std::make_shared<Builtin>(function_);
 }
 
-std::shared_ptr<Scope>& Lambda::GetScope() {
-    return scope_;
+Function* Builtin::GetFunction() const {
+    return function_.get();
 }
@@ -1,134 +1,320 @@
 #pragma once
 
+#include <cstdint>
 #include <memory>
 #include <string>
 #include <unordered_map>
 #include <vector>
 
-enum class TypeObject { NUMBER, SYMBOL, CELL, LAMBDA};
+#include <bigint.h>
+#include <symbol_table.h>
+
+enum class TypeObject { NUMBER, BIG_NUMBER, SYMBOL, CELL, LAMBDA, BUILTIN, VECTOR};
+
+class Collector;
+
+// Cells, lambdas, frames and vectors can reference each other in cycles, which shared pointers
+// never free. Every live instance of each of them is linked into a list of its kind, so that
+// the collector can find them all (see CollectCycles).
+template <class T>
+class Linked {
+public:
+    static size_t Count() {
+        return count_;
+    }
+
+protected:
+    Linked() {
+        Link();
+    }
+
+    Linked(const Linked&) {
+        Link();
+    }
+
+    Linked& operator=(const Linked&) {
+        return *this;
+    }
+
+    ~Linked() {
+        if (link_prev_) {
+            link_prev_->link_next_ = link_next_;
+        }
+        else {
+            head_ = link_next_;
+        }
+        if (link_next_) {
+            link_next_->link_prev_ = link_prev_;
+        }
+        --count_;
+    }
+
+private:
+    friend class Collector;
+
+    void Link() {
+        link_prev_ = nullptr;
+        link_next_ = head_;
+        if (head_) {
+            head_->link_prev_ = this;
+        }
+        head_ = this;
+        ++count_;
+    }
+
+    Linked* link_prev_;
+    Linked* link_next_;
+    // scratch space of the collector
+    size_t gc_index_;
+
+    static inline Linked* head_ = nullptr;
+    static inline size_t count_ = 0;
+};
 
 class Object : public std::enable_shared_from_this<Object> {
 public:
+    explicit Object(TypeObject type) : type_(type), immortal_(false) {
+    }
+
     virtual std::shared_ptr<Object> Execute() = 0;
 
     virtual std::string ToString() = 0;
 
-    virtual TypeObject GetType() = 0;
+    // The tag is stored in the object, type checks are a load and a compare.
+    TypeObject GetType() const {
+        return type_;
+    }
 
     virtual std::shared_ptr<Object> Clone() = 0;
 
     virtual ~Object() = default;
-};
 
-class Scope {
-public:
-    Scope() : prev_(nullptr) {}
-    std::shared_ptr<Scope> prev_;
-    std::unordered_map<std::string, std::shared_ptr<Object>> vars_;
+    // Returns a shared pointer to this object, for atoms that evaluate to themselves.
+    std::shared_ptr<Object> Self() {
+        if (immortal_) {
+            return std::shared_ptr<Object>(std::shared_ptr<Object>(), this);
+        }
+        return shared_from_this();
+    }
+
+private:
+    friend std::shared_ptr<Object> MakeNumber(int64_t value);
+    friend std::shared_ptr<Object> MakeSymbol(SymbolId id);
+
+    TypeObject type_;
+    bool immortal_;
 };
 
-inline std::unordered_map<std::string, std::shared_ptr<Object>> lambdas;
+// The local variables of a call of a lambda, in the slots the compiler gave them (see
+// compiler.h), and the frame of the call the lambda was made in.
+class Frame : public std::enable_shared_from_this<Frame>, public Linked<Frame> {
+public:
+    explicit Frame(size_t size) : slots_(size) {
+    }
 
-inline std::shared_ptr<Scope> curr(new Scope);
+    std::shared_ptr<Frame> prev_;
+    std::vector<std::shared_ptr<Object>> slots_;
+};
 
-inline std::vector<std::shared_ptr<Object>> arguments;
+// The global variables, looked up by name.
+inline std::unordered_map<SymbolId, std::shared_ptr<Object>> globals;
 
 class Number : public Object {
 public:
-    Number() = default;
+    static constexpr TypeObject kType = TypeObject::NUMBER;
 
-    Number(int val);
+    Number();
+
+    Number(int64_t val);
 
     std::shared_ptr<Object> Execute() override;
 
     std::string ToString() override;
 
-    TypeObject GetType() override;
+    std::shared_ptr<Object> Clone() override;
+
+    int64_t GetValue() const;
+
+    int64_t val_;
+};
+
+// An integer outside of the range of int64_t. Arithmetic returns a Number whenever the result
+// fits, so both types never hold the same value.
+class BigNumber : public Object {
+public:
+    static constexpr TypeObject kType = TypeObject::BIG_NUMBER;
+
+    explicit BigNumber(BigInt val);
+
+    std::shared_ptr<Object> Execute() override;
+
+    std::string ToString() override;
 
     std::shared_ptr<Object> Clone() override;
 
-    int GetValue() const;
+    const BigInt& GetValue() const;
 
-    int val_;
+private:
+    BigInt val_;
 };
 
 class Symbol : public Object {
 public:
-    Symbol() = default;
+    static constexpr TypeObject kType = TypeObject::SYMBOL;
+
+    Symbol();
 
     Symbol(const std::string& val);
 
+    explicit Symbol(SymbolId id);
+
     std::shared_ptr<Object> Execute() override;
 
     std::string ToString() override;
 
-    TypeObject GetType() override;
-
     std::shared_ptr<Object> Clone() override;
 
     const std::string& GetName() const;
 
-    std::string val_;
+    SymbolId GetId() const;
+
+    SymbolId id_;
 };
 
-class Cell : public Object {
+class Cell : public Object, public Linked<Cell> {
 public:
-    Cell() = default;
+    static constexpr TypeObject kType = TypeObject::CELL;
+
+    Cell();
 
     Cell(const std::shared_ptr<Object>& first, const std::shared_ptr<Object>& second);
 
+    // Frees the lists and vectors it owns alone without recursion, so lists of any length and
+    // depth can be dropped.
+    ~Cell() override;
+
     std::shared_ptr<Object> Execute() override;
 
     std::string ToString() override;
 
-    TypeObject GetType() override;
-
     std::shared_ptr<Object> Clone() override;
 
-    std::shared_ptr<Object> GetFirst() const;
+    const std::shared_ptr<Object>& GetFirst() const;
 
-    std::shared_ptr<Object> GetSecond() const;
+    const std::shared_ptr<Object>& GetSecond() const;
 
     void SetFirst(std::shared_ptr<Object> val);
 
     void SetSecond(std::shared_ptr<Object> val);
 
 private:
+    friend class Collector;
+    friend class Vector;
+
+    // Empties the lists and vectors among the objects that nothing else refers to, so that
+    // each of them dies without destroying the rest on the native stack.
+    static void ReleaseNested(std::vector<std::shared_ptr<Object>> nested);
+
     std::shared_ptr<Object> first_;
     std::shared_ptr<Object> second_;
 };
 
-class Lambda : public Object {
-public:
+struct LambdaCode;
+struct Function;
 
-    Lambda();
+// A closure: the compiled lambda expression and the frame it was evaluated in, nullptr for a
+// lambda made at the top level.
+class Lambda : public Object, public Linked<Lambda> {
+public:
+    static constexpr TypeObject kType = TypeObject::LAMBDA;
 
-    Lambda(const std::vector<std::shared_ptr<Object>>&, const std::vector<std::string>&);
+    Lambda(std::shared_ptr<const LambdaCode> code, std::shared_ptr<Frame> frame);
 
     std::shared_ptr<Object> Execute() override;
 
     std::string ToString() override;
 
-    TypeObject GetType() override;
-
     std::shared_ptr<Object> Clone() override;
 
-    std::vector<std::shared_ptr<Object>> GetBody();
+    const LambdaCode& GetCode() const;
 
-    std::vector<std::string>& GetVars();
+    const std::shared_ptr<Frame>& GetFrame() const;
 
-    std::shared_ptr<Scope>& GetScope();
+private:
+    friend class Collector;
+
+    std::shared_ptr<const LambdaCode> code_;
+
+    std::shared_ptr<Frame> frame_;
+};
+
+// A builtin procedure as a value, what the name of a builtin evaluates to.
+class Builtin : public Object {
+public:
+    static constexpr TypeObject kType = TypeObject::BUILTIN;
+
+    explicit Builtin(std::shared_ptr<Function> function);
+
+    std::shared_ptr<Object> Execute() override;
+
+    std::string ToString() override;
+
+    std::shared_ptr<Object> Clone() override;
+
+    Function* GetFunction() const;
 
 private:
+    std::shared_ptr<Function> function_;
+};
+
+class Vector : public Object, public Linked<Vector> {
+public:
+    static constexpr TypeObject kType = TypeObject::VECTOR;
+
+    Vector();
+
+    explicit Vector(std::vector<std::shared_ptr<Object>> elements);
+
+    // Like ~Cell, so vectors of any depth can be dropped.
+    ~Vector() override;
+
+    std::shared_ptr<Object> Execute() override;
+
+    std::string ToString() override;
 
-    std::vector<std::shared_ptr<Object>> body_;
+    std::shared_ptr<Object> Clone() override;
 
-    std::vector<std::string> l_vars_;
+    std::vector<std::shared_ptr<Object>>& GetElements();
 
-    std::shared_ptr<Scope> scope_;
+private:
+    friend class Collector;
 
+    std::vector<std::shared_ptr<Object>> elements_;
 };
 
+// Small numbers and the booleans are cached: they are preallocated objects that live as long
+// as the process, referenced by shared pointers without a control block. Making one does not
+// allocate and copying one updates no reference count, but it is still a full shared pointer,
+// not a tagged value.
+constexpr int kMinCachedNumber = -1024;
+constexpr int kMaxCachedNumber = 1024;
+
+inline bool IsCachedNumber(int64_t value) {
+    return kMinCachedNumber <= value && value <= kMaxCachedNumber;
+}
+
+// The cached Number when the value is small enough, a new one otherwise.
+std::shared_ptr<Object> MakeNumber(int64_t value);
+
+// A Number when the value fits into int64_t, a BigNumber otherwise.
+std::shared_ptr<Object> MakeNumber(BigInt value);
+
+// Symbols are cached too: there is one object for every interned name.
+std::shared_ptr<Object> MakeSymbol(SymbolId id);
+
+// The symbols #t and #f.
+std::shared_ptr<Object> MakeBoolean(bool value);
+
 ///////////////////////////////////////////////////////////////////////////////
 
 // Runtime type checking and convertion.
@@ -141,8 +327,5 @@ std::shared_ptr<T> As(const std::shared_ptr<Object>& obj) {
 
 template <class T>
 bool Is(const std::shared_ptr<Object>& obj) {
-    if (obj == nullptr) {
-        return false;
-    }
-    return T().GetType() == obj->GetType();
+    return obj != nullptr && obj->GetType() == T::kType;
 }
@@ -0,0 +1,38 @@
+#include <parse_cache.h>
+
+ParseCache::ParseCache(size_t capacity) : capacity_(capacity), hits_(0), misses_(0) {
+}
+
+ParseCache::Program* ParseCache::Find(std::string_view source) {
+    if (capacity_ == 0) {
+        return nullptr;
+    }
+    auto it = index_.find(source);
+    if (it == index_.end()) {
+        ++misses_;
+        return nullptr;
+    }
+    ++hits_;
+    entries_.splice(entries_.begin(), entries_, it->second);
+    return &it->second->program;
+}
+
+ParseCache::Program* ParseCache::Insert(std::string_view source, std::shared_ptr<Object> form) {
+    if (capacity_ == 0) {
+        return nullptr;
+    }
+    if (auto it = index_.find(source); it != index_.end()) {
+        return &it->second->program;
+    }
+    if (entries_.size() == capacity_) {
+        index_.erase(entries_.back().source);
+        entries_.pop_back();
+    }
+    entries_.push_front(Entry{std::string(source), Program{std::move(form), nullptr}});
+    index_.emplace(entries_.front().source, entries_.begin());
+    return &entries_.front().program;
+}
+
+ParseCache::Stats ParseCache::GetStats() const {
+    return Stats{hits_, misses_, entries_.size()};
+}
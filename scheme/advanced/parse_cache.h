@@ -0,0 +1,56 @@
+#pragma once
+
+#include <compiler.h>
+#include <object.h>
+
+#include <list>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+// Bounded LRU cache of parsed programs keyed by their source text. A hit is found by the
+// hash of the text and confirmed by comparing the text itself. The compiled code of a program
+// is kept next to it, so a hit skips compiling as well.
+//
+// Cached programs are shared between runs, so a program that mutates its own literals
+// (set-car! on a quoted list) sees the mutation on the next hit. Mutating literals is an
+// error in Scheme, which is why the cache is opt-in.
+class ParseCache {
+public:
+    struct Stats {
+        size_t hits;
+        size_t misses;
+        size_t size;
+    };
+
+    struct Program {
+        std::shared_ptr<Object> form;
+        // made by the first run of the program
+        std::shared_ptr<Node> code;
+    };
+
+    // A cache with zero capacity is disabled: it never stores anything and counts nothing.
+    explicit ParseCache(size_t capacity);
+
+    // Returns nullptr on a miss. The program stays valid until the next Insert.
+    Program* Find(std::string_view source);
+
+    // Returns the cached program, nullptr if the cache is disabled.
+    Program* Insert(std::string_view source, std::shared_ptr<Object> form);
+
+    Stats GetStats() const;
+
+private:
+    struct Entry {
+        std::string source;
+        Program program;
+    };
+
+    size_t capacity_;
+    size_t hits_;
+    size_t misses_;
+    // most recently used first, the map keys point into the entries' sources
+    std::list<Entry> entries_;
+    std::unordered_map<std::string_view, std::list<Entry>::iterator> index_;
+};
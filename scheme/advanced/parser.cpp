@@ -1,76 +1,159 @@
 #include <parser.h>
 #include <error.h>
 
-std::shared_ptr<Object> Read(Tokenizer* tokenizer) {
+namespace {
 
-    if (tokenizer->IsEnd()) {
-        throw SyntaxError("Empty");
-    }
-    Token t = tokenizer->GetToken();
-    tokenizer->Next();
+// An open list or a pending quote on the explicit parser stack.
+struct Frame {
+    enum class Kind { LIST, QUOTE };
+    // Where a list is relative to its dot: none seen yet, waiting for the tail, tail read.
+    enum class Dot { NONE, EXPECT_TAIL, HAS_TAIL };
 
-    if (std::get_if<ConstantToken>(&t)) {
-        return std::make_shared<Number>(std::get<ConstantToken>(t).value);
-    }
-    else if (std::get_if<BracketToken>(&t)) {
-        if (std::get<BracketToken>(t) == BracketToken::OPEN) {
-            return ReadList(tokenizer);
-        }
-        else {
-            throw SyntaxError("No matching open bracket for close bracket");
-        }
+    Kind kind;
+    Dot dot;
+    std::shared_ptr<Object> head;
+    Cell* tail;
+};
+
+Frame ListFrame() {
+    return Frame{Frame::Kind::LIST, Frame::Dot::NONE, nullptr, nullptr};
+}
+
+Frame QuoteFrame() {
+    return Frame{Frame::Kind::QUOTE, Frame::Dot::NONE, nullptr, nullptr};
+}
+
+void Append(Frame* list, std::shared_ptr<Object> value, const ArenaAllocator<Object>* arena) {
+    if (list->dot == Frame::Dot::EXPECT_TAIL) {
+        list->tail->SetSecond(std::move(value));
+        list->dot = Frame::Dot::HAS_TAIL;
+        return;
     }
-    else if (std::get_if<SymbolToken>(&t)) {
-        return std::make_shared<Symbol>(std::get<SymbolToken>(t).name);
+    if (list->dot == Frame::Dot::HAS_TAIL) {
+        throw SyntaxError("Bad dot");
     }
-    else if (std::get_if<QuoteToken>(&t)) {
-        return std::make_shared<Cell>(std::make_shared<Symbol>("quote"),
-            std::make_shared<Cell>(Read(tokenizer), nullptr));
+    auto cell = MakeNode<Cell>(arena, std::move(value), nullptr);
+    Cell* raw = cell.get();
+    if (list->tail) {
+        list->tail->SetSecond(std::move(cell));
     }
     else {
-        return std::make_shared<Symbol>(".");
+        list->head = std::move(cell);
     }
+    list->tail = raw;
 }
 
-std::shared_ptr<Object> BuildList(const std::vector<std::shared_ptr<Object>>& list, size_t pos) {
-
-    if (pos == list.size()) {
-        return nullptr;
+// Reads one datum, or the rest of a list when its open bracket is already consumed.
+// Nested lists and quotes live on an explicit stack, so depth is bounded by memory only.
+std::shared_ptr<Object> ReadDatum(Tokenizer* tokenizer, bool in_list,
+                                  const ArenaAllocator<Object>* arena) {
+    std::vector<Frame> stack;
+    if (in_list) {
+        stack.push_back(ListFrame());
     }
-    else {
-        if (list[pos] && list[pos]->GetType() == TypeObject::SYMBOL &&
-            static_pointer_cast<Symbol>(list[pos])->GetName() == ".") {
-            if (pos != 0 && pos == list.size() - 2) {
-                return list.back();
+    while (true) {
+        if (tokenizer->IsEnd()) {
+            if (!stack.empty() && stack.back().kind == Frame::Kind::LIST) {
+                throw SyntaxError("No matching close bracket for open bracket");
+            }
+            throw SyntaxError("Empty");
+        }
+        const Token& t = tokenizer->GetToken();
+        std::shared_ptr<Object> value;
+
+        if (std::get_if<ConstantToken>(&t)) {
+            int64_t number = std::get<ConstantToken>(t).value;
+            value = IsCachedNumber(number) ? MakeNumber(number) : MakeNode<Number>(arena, number);
+            tokenizer->Next();
+        }
+        else if (std::get_if<BigNumberToken>(&t)) {
+            value = MakeNumber(*std::get<BigNumberToken>(t).value);
+            tokenizer->Next();
+        }
+        else if (std::get_if<SymbolToken>(&t)) {
+            value = MakeSymbol(std::get<SymbolToken>(t).id);
+            tokenizer->Next();
+        }
+        else if (std::get_if<BracketToken>(&t)) {
+            if (std::get<BracketToken>(t) == BracketToken::OPEN) {
+                tokenizer->Next();
+                stack.push_back(ListFrame());
+                continue;
+            }
+            if (stack.empty() || stack.back().kind != Frame::Kind::LIST) {
+                throw SyntaxError("No matching open bracket for close bracket");
             }
-            else {
+            if (stack.back().dot == Frame::Dot::EXPECT_TAIL) {
                 throw SyntaxError("Bad dot");
             }
+            tokenizer->Next();
+            value = std::move(stack.back().head);
+            stack.pop_back();
         }
-        return std::make_shared<Cell>(list[pos], BuildList(list, pos + 1));
+        else if (std::get_if<QuoteToken>(&t)) {
+            tokenizer->Next();
+            stack.push_back(QuoteFrame());
+            continue;
+        }
+        else {
+            tokenizer->Next();
+            if (!stack.empty() && stack.back().kind == Frame::Kind::LIST &&
+                stack.back().dot != Frame::Dot::EXPECT_TAIL) {
+                if (!stack.back().head || stack.back().dot == Frame::Dot::HAS_TAIL) {
+                    throw SyntaxError("Bad dot");
+                }
+                stack.back().dot = Frame::Dot::EXPECT_TAIL;
+                continue;
+            }
+            // outside of a list, or right after another dot, a dot reads as a symbol
+            value = MakeSymbol(kDotSymbol);
+        }
+
+        while (!stack.empty() && stack.back().kind == Frame::Kind::QUOTE) {
+            stack.pop_back();
+            value = MakeNode<Cell>(arena, MakeSymbol(kQuoteSymbol),
+                MakeNode<Cell>(arena, std::move(value), nullptr));
+        }
+        if (stack.empty()) {
+            return value;
+        }
+        Append(&stack.back(), std::move(value), arena);
     }
 }
 
-std::shared_ptr<Object> ReadList(Tokenizer* tokenizer) {
-
-    if (tokenizer->IsEnd()) {
-        throw SyntaxError("No matching close bracket for open bracket");
-    }
+}  // namespace
 
-    std::vector<std::shared_ptr<Object>> list;
+std::shared_ptr<Object> Read(Tokenizer* tokenizer) {
+    return ReadDatum(tokenizer, false, nullptr);
+}
 
-    Token t = tokenizer->GetToken();
+std::shared_ptr<Object> Read(Tokenizer* tokenizer, const ArenaAllocator<Object>& arena) {
+    return ReadDatum(tokenizer, false, &arena);
+}
 
-    while (!tokenizer->IsEnd() &&
-        !(std::get_if<BracketToken>(&t) && std::get<BracketToken>(t) == BracketToken::CLOSE)) {
-        list.push_back(Read(tokenizer));
-        if (!tokenizer->IsEnd()) {
-            t = tokenizer->GetToken();
+std::shared_ptr<Object> BuildList(const std::vector<std::shared_ptr<Object>>& list, size_t pos) {
+    size_t end = list.size();
+    std::shared_ptr<Object> ret = nullptr;
+    // only the first dot counts, it has to be followed by exactly one element
+    for (size_t i = pos; i < list.size(); ++i) {
+        if (list[i] && list[i]->GetType() == TypeObject::SYMBOL &&
+            static_pointer_cast<Symbol>(list[i])->GetId() == kDotSymbol) {
+            if (i == pos || i != list.size() - 2) {
+                throw SyntaxError("Bad dot");
+            }
+            end = i;
+            ret = list.back();
+            break;
         }
     }
-    if (tokenizer->IsEnd()) {
-        throw SyntaxError("No matching close bracket for open bracket");
+    // built from the tail, so every cell is created with its final successor
+    while (end > pos) {
+        --end;
+        ret = MakeCell(list[end], std::move(ret));
     }
-    tokenizer->Next();
-    return BuildList(list, 0);
-}
\ No newline at end of file
+    return ret;
+}
+
+std::shared_ptr<Object> ReadList(Tokenizer* tokenizer) {
+    return ReadDatum(tokenizer, true, nullptr);
+}
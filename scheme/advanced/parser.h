@@ -5,7 +5,20 @@
 
 #include "object.h"
 #include <tokenizer.h>
+#include <arena.h>
+#include <cell_pool.h>
+
+// Nodes go to the arena when there is one and to the node pool otherwise.
+template <class T, class... Args>
+std::shared_ptr<T> MakeNode(const ArenaAllocator<Object>* arena, Args&&... args) {
+    if (arena) {
+        return std::allocate_shared<T>(*arena, std::forward<Args>(args)...);
+    }
+    return std::allocate_shared<T>(PoolAllocator<T>(), std::forward<Args>(args)...);
+}
 
 std::shared_ptr<Object> Read(Tokenizer* tokenizer);
+// Allocates the nodes in the arena, see ArenaAllocator for their lifetime.
+std::shared_ptr<Object> Read(Tokenizer* tokenizer, const ArenaAllocator<Object>& arena);
 std::shared_ptr<Object> ReadList(Tokenizer* tokenizer);
 std::shared_ptr<Object> BuildList(const std::vector<std::shared_ptr<Object>>& list, size_t pos);
@@ -0,0 +1,243 @@
+#include <program_image.h>
+#include <error.h>
+
+#include <cstring>
+#include <unordered_map>
+
+namespace {
+
+constexpr char kMagic[4] = {'S', 'C', 'M', 'I'};
+constexpr uint32_t kVersion = 2;
+
+// BIG_NUMBER came later, images without it read the same
+enum Op : uint8_t { NUMBER, SYMBOL, NIL, LIST, END, BIG_NUMBER };
+
+class ImageWriter {
+public:
+    void WriteForm(const std::shared_ptr<Object>& form) {
+        // a list in progress: the rest of its spine and the number of elements written
+        struct Frame {
+            std::shared_ptr<Object> rest;
+            uint32_t count;
+        };
+        std::vector<Frame> stack;
+        auto write = [&](const std::shared_ptr<Object>& obj) {
+            if (Is<Cell>(obj)) {
+                stack.push_back(Frame{obj, 0});
+            }
+            else {
+                WriteAtom(obj);
+            }
+        };
+        write(form);
+        while (!stack.empty()) {
+            auto rest = stack.back().rest;
+            if (Is<Cell>(rest)) {
+                auto cell = As<Cell>(rest);
+                stack.back().rest = cell->GetSecond();
+                ++stack.back().count;
+                write(cell->GetFirst());
+                continue;
+            }
+            WriteAtom(rest);
+            body_.push_back(LIST);
+            WriteValue(stack.back().count);
+            stack.pop_back();
+        }
+        body_.push_back(END);
+    }
+
+    std::string Finish() {
+        std::string image(kMagic, sizeof(kMagic));
+        AppendValue(&image, kVersion);
+        AppendValue(&image, static_cast<uint32_t>(symbols_.size()));
+        for (SymbolId id : symbols_) {
+            const auto& name = GetSymbolName(id);
+            AppendValue(&image, static_cast<uint32_t>(name.size()));
+            image += name;
+        }
+        image += body_;
+        return image;
+    }
+
+private:
+    template <class T>
+    static void AppendValue(std::string* out, T value) {
+        char bytes[sizeof(T)];
+        std::memcpy(bytes, &value, sizeof(T));
+        out->append(bytes, sizeof(T));
+    }
+
+    template <class T>
+    void WriteValue(T value) {
+        AppendValue(&body_, value);
+    }
+
+    void WriteAtom(const std::shared_ptr<Object>& obj) {
+        if (!obj) {
+            body_.push_back(NIL);
+        }
+        else if (Is<Number>(obj)) {
+            body_.push_back(NUMBER);
+            WriteValue<int64_t>(As<Number>(obj)->GetValue());
+        }
+        else if (Is<BigNumber>(obj)) {
+            // in decimal, the limbs are an implementation detail of BigInt
+            std::string digits = As<BigNumber>(obj)->GetValue().ToString();
+            body_.push_back(BIG_NUMBER);
+            WriteValue<uint32_t>(digits.size());
+            body_ += digits;
+        }
+        else if (Is<Symbol>(obj)) {
+            SymbolId id = As<Symbol>(obj)->GetId();
+            auto [it, inserted] = indices_.emplace(id, symbols_.size());
+            if (inserted) {
+                symbols_.push_back(id);
+            }
+            body_.push_back(SYMBOL);
+            WriteValue<uint32_t>(it->second);
+        }
+        else {
+            throw RuntimeError("Only numbers, symbols and lists can be compiled");
+        }
+    }
+
+    // the symbols of the image in the order of the table and their indices in it
+    std::vector<SymbolId> symbols_;
+    std::unordered_map<SymbolId, uint32_t> indices_;
+    std::string body_;
+};
+
+}  // namespace
+
+std::string CompileProgram(std::string_view source) {
+    Tokenizer tokenizer(source);
+    ImageWriter writer;
+    while (!tokenizer.IsEnd()) {
+        writer.WriteForm(Read(&tokenizer));
+    }
+    return writer.Finish();
+}
+
+std::string WriteProgramImage(const std::vector<std::shared_ptr<Object>>& forms) {
+    ImageWriter writer;
+    for (const auto& form : forms) {
+        writer.WriteForm(form);
+    }
+    return writer.Finish();
+}
+
+ProgramImage::ProgramImage(const std::string& path)
+    : file_(std::make_unique<MappedFile>(path)), image_(file_->View()), pos_(0) {
+    Open();
+}
+
+ProgramImage::ProgramImage(std::string_view image) : image_(image), pos_(0) {
+    Open();
+}
+
+template <class T>
+T ProgramImage::ReadValue() {
+    if (image_.size() - pos_ < sizeof(T)) {
+        throw RuntimeError("Corrupted program image");
+    }
+    T value;
+    std::memcpy(&value, image_.data() + pos_, sizeof(T));
+    pos_ += sizeof(T);
+    return value;
+}
+
+void ProgramImage::Open() {
+    if (image_.substr(0, sizeof(kMagic)) != std::string_view(kMagic, sizeof(kMagic))) {
+        throw RuntimeError("Not a program image");
+    }
+    pos_ = sizeof(kMagic);
+    if (ReadValue<uint32_t>() != kVersion) {
+        throw RuntimeError("Unsupported program image version");
+    }
+    symbols_.resize(ReadValue<uint32_t>());
+    for (auto& id : symbols_) {
+        auto size = ReadValue<uint32_t>();
+        if (image_.size() - pos_ < size) {
+            throw RuntimeError("Corrupted program image");
+        }
+        id = Intern(image_.substr(pos_, size));
+        pos_ += size;
+    }
+}
+
+bool ProgramImage::IsEnd() const {
+    return pos_ == image_.size();
+}
+
+std::shared_ptr<Object> ProgramImage::ReadForm(const ArenaAllocator<Object>* arena) {
+    stack_.clear();
+    while (true) {
+        switch (ReadValue<uint8_t>()) {
+            case NUMBER: {
+                int64_t number = ReadValue<int64_t>();
+                stack_.push_back(IsCachedNumber(number) ? MakeNumber(number)
+                                                        : MakeNode<Number>(arena, number));
+                break;
+            }
+            case BIG_NUMBER: {
+                auto size = ReadValue<uint32_t>();
+                if (image_.size() - pos_ < size) {
+                    throw RuntimeError("Corrupted program image");
+                }
+                auto digits = image_.substr(pos_, size);
+                pos_ += size;
+                size_t first = !digits.empty() && digits[0] == '-';
+                if (first == digits.size() ||
+                    digits.find_first_not_of("0123456789", first) != std::string_view::npos) {
+                    throw RuntimeError("Corrupted program image");
+                }
+                stack_.push_back(MakeNumber(BigInt::FromString(digits)));
+                break;
+            }
+            case SYMBOL: {
+                auto id = ReadValue<uint32_t>();
+                if (id >= symbols_.size()) {
+                    throw RuntimeError("Corrupted program image");
+                }
+                stack_.push_back(MakeSymbol(symbols_[id]));
+                break;
+            }
+            case NIL:
+                stack_.push_back(nullptr);
+                break;
+            case LIST: {
+                auto count = ReadValue<uint32_t>();
+                if (stack_.size() <= count) {
+                    throw RuntimeError("Corrupted program image");
+                }
+                auto list = std::move(stack_.back());
+                stack_.pop_back();
+                for (; count > 0; --count) {
+                    list = MakeNode<Cell>(arena, std::move(stack_.back()), std::move(list));
+                    stack_.pop_back();
+                }
+                stack_.push_back(std::move(list));
+                break;
+            }
+            case END: {
+                if (stack_.size() != 1) {
+                    throw RuntimeError("Corrupted program image");
+                }
+                auto form = std::move(stack_.back());
+                stack_.pop_back();
+                return form;
+            }
+            default:
+                throw RuntimeError("Corrupted program image");
+        }
+    }
+}
+
+std::shared_ptr<Object> Read(ProgramImage* image) {
+    return image->ReadForm(nullptr);
+}
+
+std::shared_ptr<Object> Read(ProgramImage* image, const ArenaAllocator<Object>& arena) {
+    return image->ReadForm(&arena);
+}
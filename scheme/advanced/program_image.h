@@ -0,0 +1,66 @@
+#pragma once
+
+#include <parser.h>
+#include <mapped_file.h>
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Binary form of parsed programs, so that a large program is parsed once and later only
+// loaded. An image is a header, a table of the distinct symbol names and the forms, each
+// written in postfix order:
+//
+//   NUMBER <int64>    pushes a number
+//   SYMBOL <uint32>   pushes the symbol with this index in the table
+//   NIL               pushes the empty list
+//   LIST <uint32 n>   pops the tail and n elements under it, pushes the list they make
+//   END               pops a finished form
+//
+// Lists are flattened, so neither writing nor loading recurses. The names are interned once
+// when the image is opened. Integers are stored in the byte order of the machine that wrote
+// the image: images are a cache, not an exchange format.
+
+// Parses every form of the source and returns its image.
+std::string CompileProgram(std::string_view source);
+
+// Writes the image of the forms, which must be trees of numbers, symbols and cells as
+// Read returns them. Throws RuntimeError on anything else.
+std::string WriteProgramImage(const std::vector<std::shared_ptr<Object>>& forms);
+
+class ProgramImage {
+public:
+    // Maps the image file, the forms are decoded lazily by Read.
+    explicit ProgramImage(const std::string& path);
+
+    // Reads an image from memory, which must outlive the ProgramImage.
+    explicit ProgramImage(std::string_view image);
+
+    ProgramImage(const ProgramImage&) = delete;
+    ProgramImage& operator=(const ProgramImage&) = delete;
+
+    bool IsEnd() const;
+
+    // Decodes the next form, used by Read. Nodes go to the heap when arena is nullptr.
+    std::shared_ptr<Object> ReadForm(const ArenaAllocator<Object>* arena);
+
+private:
+    void Open();
+
+    template <class T>
+    T ReadValue();
+
+    std::unique_ptr<MappedFile> file_;
+    std::string_view image_;
+    size_t pos_;
+    // the interned ids of the image's symbol table
+    std::vector<SymbolId> symbols_;
+    std::vector<std::shared_ptr<Object>> stack_;
+};
+
+// Load the next form of the image. The result is built from the same objects as the result
+// of Read over the source text.
+std::shared_ptr<Object> Read(ProgramImage* image);
+std::shared_ptr<Object> Read(ProgramImage* image, const ArenaAllocator<Object>& arena);
@@ -1,39 +1,18 @@
 #include "scheme.h"
 #include <unordered_map>
-#include <sstream>
 #include <error.h>
+#include <compiler.h>
+#include <vm.h>
 #include <vector>
+#include <cstdlib>
+#include <cstring>
 #include <iostream>
-
-struct Function {
-    virtual std::shared_ptr<Object> operator()(std::shared_ptr<Object> obj) = 0;
-
-    virtual ~Function() = default;
-};
-
-std::vector<std::shared_ptr<Object>> CellToVector(std::shared_ptr<Object> list) {
-    std::vector<std::shared_ptr<Object>> ret;
-    if (list == nullptr) {
-        return ret;
-    }
-    while (Is<Cell>(As<Cell>(list)->GetSecond())) {
-        ret.push_back(As<Cell>(list)->GetFirst());
-        list = As<Cell>(list)->GetSecond();
-    }
-    if (As<Cell>(list)->GetFirst()) {
-        ret.push_back(As<Cell>(list)->GetFirst());
-    }
-    else {
-        ret.push_back(nullptr);
-    }
-    if (As<Cell>(list)->GetSecond()) {
-        ret.push_back(As<Cell>(list)->GetSecond());
-    }
-    return ret;
-}
+#include <limits>
+#include <new>
+#include <stdexcept>
 
 template <class T>
-bool IsListOfT(std::vector<std::shared_ptr<Object>>& list) {
+bool IsListOfT(Arguments list) {
     bool ret = true;
     for (size_t i = 0; i < list.size(); ++i) {
         if (!Is<T>(list[i])) {
@@ -43,587 +22,617 @@ bool IsListOfT(std::vector<std::shared_ptr<Object>>& list) {
     return ret;
 }
 
-bool IsListOfSize(std::vector<std::shared_ptr<Object>>& list, size_t n) {
+bool IsListOfSize(Arguments list, size_t n) {
     return list.size() == n;
 }
 
-struct IsNumber : Function {
-    std::shared_ptr<Object> operator()(std::shared_ptr<Object> obj) override {
-        std::vector<std::shared_ptr<Object>> list = CellToVector(obj);
-        for (size_t i = 0; i < list.size(); ++i) {
-            if (!list[i]) {
-                throw RuntimeError("Wronggg");
-            }
-            list[i] = list[i]->Execute();
+// Follows index cdrs from list, sharing the rest of it, throws if the list ends earlier.
+// Walks the slots holding the cdrs, so no reference counts change on the way.
+std::shared_ptr<Object> SkipCells(const std::shared_ptr<Object>& list,
+                                  const std::shared_ptr<Object>& index) {
+    if (!Is<Number>(index) || As<Number>(index)->GetValue() < 0) {
+        throw RuntimeError("Wrong input");
+    }
+    const std::shared_ptr<Object>* rest = &list;
+    for (int64_t i = As<Number>(index)->GetValue(); i > 0; --i) {
+        if (!Is<Cell>(*rest)) {
+            throw RuntimeError("Bad index");
+        }
+        rest = &static_cast<const Cell&>(**rest).GetSecond();
+    }
+    return *rest;
+}
+
+bool IsInteger(const std::shared_ptr<Object>& obj) {
+    return Is<Number>(obj) || Is<BigNumber>(obj);
+}
+
+void CheckIntegers(Arguments list) {
+    for (const auto& obj : list) {
+        if (!IsInteger(obj)) {
+            throw RuntimeError("Wrong type");
         }
-        if (IsListOfT<Number>(list) && IsListOfSize(list, 1)) {
-            return std::make_shared<Symbol>("#t");
+    }
+}
+
+BigInt ToBigInt(const std::shared_ptr<Object>& obj) {
+    if (Is<Number>(obj)) {
+        return As<Number>(obj)->GetValue();
+    }
+    return As<BigNumber>(obj)->GetValue();
+}
+
+struct IsNumber : Function {
+    std::shared_ptr<Object> operator()(Arguments list) override {
+        if (IsListOfSize(list, 1) && IsInteger(list[0])) {
+            return MakeBoolean(true);
         }
-        return std::make_shared<Symbol>("#f");
+        return MakeBoolean(false);
     }
 };
 
 struct Greater {
-    bool operator()(int a, int b) {
+    bool operator()(int64_t a, int64_t b) {
         return a > b;
     }
 };
 
 struct Less {
-    bool operator()(int a, int b) {
+    bool operator()(int64_t a, int64_t b) {
         return a < b;
     }
 };
 
 struct GreaterEqual {
-    bool operator()(int a, int b) {
+    bool operator()(int64_t a, int64_t b) {
         return a >= b;
     }
 };
 
 struct LessEqual {
-    bool operator()(int a, int b) {
+    bool operator()(int64_t a, int64_t b) {
         return a <= b;
     }
 };
 
 struct Equal {
-    bool operator()(int a, int b) {
+    bool operator()(int64_t a, int64_t b) {
         return a == b;
     }
 };
 
 template <class Comp>
 struct Compare : Function {
-    std::shared_ptr<Object> operator()(std::shared_ptr<Object> obj) override {
-        std::vector<std::shared_ptr<Object>> list = CellToVector(obj);
-        for (size_t i = 0; i < list.size(); ++i) {
-            if (!list[i]) {
-                throw RuntimeError("Wronggg");
-            }
-            list[i] = list[i]->Execute();
-        }
-        if (!IsListOfT<Number>(list)) {
-            throw RuntimeError("Wrong type");
-        }
+    std::shared_ptr<Object> operator()(Arguments list) override {
+        CheckIntegers(list);
         bool f = true;
         for (size_t i = 1; i < list.size(); ++i) {
-            if (!Comp()(As<Number>(list[i - 1])->GetValue(), As<Number>(list[i])->GetValue())) {
+            bool holds;
+            if (Is<Number>(list[i - 1]) && Is<Number>(list[i])) {
+                holds = Comp()(As<Number>(list[i - 1])->GetValue(), As<Number>(list[i])->GetValue());
+            }
+            else {
+                holds = Comp()(ToBigInt(list[i - 1]).Compare(ToBigInt(list[i])), 0);
+            }
+            if (!holds) {
                 f = false;
                 break;
             }
         }
         if (f) {
-            return std::make_shared<Symbol>("#t");
+            return MakeBoolean(true);
         }
-        return std::make_shared<Symbol>("#f");
+        return MakeBoolean(false);
     }
 };
 
+// Every arithmetic operation has a fixnum form, which returns false when the result does not
+// fit into int64_t, and a BigInt form for the rest.
 struct Sum {
-    int operator()(int a, int b) {
+    static constexpr int64_t kIdentity = 0;
+
+    bool operator()(int64_t a, int64_t b, int64_t* ret) {
+        return !__builtin_add_overflow(a, b, ret);
+    }
+
+    BigInt operator()(const BigInt& a, const BigInt& b) {
         return a + b;
     }
 };
 
 struct Mul {
-    int operator()(int a, int b) {
+    static constexpr int64_t kIdentity = 1;
+
+    bool operator()(int64_t a, int64_t b, int64_t* ret) {
+        return !__builtin_mul_overflow(a, b, ret);
+    }
+
+    BigInt operator()(const BigInt& a, const BigInt& b) {
         return a * b;
     }
 };
 
+// Folds list[begin..] into ret with Op, in int64_t until a step overflows or meets a
+// BigNumber, and in BigInt from there on.
 template <class Op>
-struct DefFirst : Function {
-    std::shared_ptr<Object> operator()(std::shared_ptr<Object> obj) override {
-        std::vector<std::shared_ptr<Object>> list = CellToVector(obj);
-        for (size_t i = 0; i < list.size(); ++i) {
-            if (!list[i]) {
-                throw RuntimeError("Wronggg");
-            }
-            list[i] = list[i]->Execute();
+std::shared_ptr<Object> FoldNumbers(Arguments list, size_t begin, int64_t ret) {
+    size_t i = begin;
+    for (; i < list.size() && Is<Number>(list[i]); ++i) {
+        int64_t next;
+        if (!Op()(ret, As<Number>(list[i])->GetValue(), &next)) {
+            break;
         }
-        if (!IsListOfT<Number>(list)) {
-            throw RuntimeError("Wrong type");
-        }
-        int ret;
-        if (typeid(Op) == typeid(Sum)) {
-            ret = 0;
-        }
-        else {
-            ret = 1;
-        }
-        for (size_t i = 0; i < list.size(); ++i) {
-            ret = Op()(ret, As<Number>(list[i])->GetValue());
-        }
-        return std::make_shared<Number>(ret);
+        ret = next;
+    }
+    if (i == list.size()) {
+        return MakeNumber(ret);
+    }
+    BigInt big = ret;
+    for (; i < list.size(); ++i) {
+        big = Op()(big, ToBigInt(list[i]));
+    }
+    return MakeNumber(std::move(big));
+}
+
+template <class Op>
+struct DefFirst : Function {
+    std::shared_ptr<Object> operator()(Arguments list) override {
+        CheckIntegers(list);
+        return FoldNumbers<Op>(list, 0, Op::kIdentity);
     }
 };
 
 struct Minus {
-    int operator()(int a, int b) {
+    bool operator()(int64_t a, int64_t b, int64_t* ret) {
+        return !__builtin_sub_overflow(a, b, ret);
+    }
+
+    BigInt operator()(const BigInt& a, const BigInt& b) {
         return a - b;
     }
 };
 
 struct Devide {
-    int operator()(int a, int b) {
+    bool operator()(int64_t a, int64_t b, int64_t* ret) {
+        if (b == 0) {
+            throw RuntimeError("Division by zero");
+        }
+        if (b == -1 && a == std::numeric_limits<int64_t>::min()) {
+            return false;
+        }
+        *ret = a / b;
+        return true;
+    }
+
+    BigInt operator()(const BigInt& a, const BigInt& b) {
+        if (b.IsZero()) {
+            throw RuntimeError("Division by zero");
+        }
         return a / b;
     }
 };
 
 struct Max {
-    int operator()(int a, int b) {
-        return std::max(a, b);
+    bool operator()(int64_t a, int64_t b, int64_t* ret) {
+        *ret = std::max(a, b);
+        return true;
+    }
+
+    BigInt operator()(const BigInt& a, const BigInt& b) {
+        return a.Compare(b) >= 0 ? a : b;
     }
 };
 
 struct Min {
-    int operator()(int a, int b) {
-        return std::min(a, b);
+    bool operator()(int64_t a, int64_t b, int64_t* ret) {
+        *ret = std::min(a, b);
+        return true;
+    }
+
+    BigInt operator()(const BigInt& a, const BigInt& b) {
+        return a.Compare(b) <= 0 ? a : b;
     }
 };
 
 template <class Op>
 struct NotDefFirst : Function {
-    std::shared_ptr<Object> operator()(std::shared_ptr<Object> obj) override {
-        std::vector<std::shared_ptr<Object>> list = CellToVector(obj);
-        for (size_t i = 0; i < list.size(); ++i) {
-            if (!list[i]) {
-                throw RuntimeError("Wronggg");
-            }
-            list[i] = list[i]->Execute();
-        }
-        if (!IsListOfT<Number>(list)) {
-            throw RuntimeError("Wrong type");
-        }
+    std::shared_ptr<Object> operator()(Arguments list) override {
+        CheckIntegers(list);
         if (IsListOfSize(list, 0)) {
             throw RuntimeError(std::string("No input for ") + std::string(typeid(Op).name()));
         }
-        int ret = As<Number>(list[0])->GetValue();
+        if (Is<Number>(list[0])) {
+            return FoldNumbers<Op>(list, 1, As<Number>(list[0])->GetValue());
+        }
+        BigInt ret = As<BigNumber>(list[0])->GetValue();
         for (size_t i = 1; i < list.size(); ++i) {
-            ret = Op()(ret, As<Number>(list[i])->GetValue());
+            ret = Op()(ret, ToBigInt(list[i]));
         }
-        return std::make_shared<Number>(ret);
+        return MakeNumber(std::move(ret));
     }
 };
 
 struct Abs : Function {
-    std::shared_ptr<Object> operator()(std::shared_ptr<Object> obj) override {
-        std::vector<std::shared_ptr<Object>> list = CellToVector(obj);
-        for (size_t i = 0; i < list.size(); ++i) {
-            if (!list[i]) {
-                throw RuntimeError("Wronggg");
-            }
-            list[i] = list[i]->Execute();
-        }
-        if (!IsListOfT<Number>(list)) {
-            throw RuntimeError("Wrong type");
-        }
+    std::shared_ptr<Object> operator()(Arguments list) override {
+        CheckIntegers(list);
         if (!IsListOfSize(list, 1)) {
             throw RuntimeError(std::string("Wrong input for abs"));
         }
-        return std::make_shared<Number>(std::abs(As<Number>(list[0])->GetValue()));
-    }
-};
-
-struct Quote : Function {
-    std::shared_ptr<Object> operator()(std::shared_ptr<Object> obj) override {
-        std::vector<std::shared_ptr<Object>> list = CellToVector(obj);
-        if (!IsListOfSize(list, 1)) {
-            throw RuntimeError("Wrong input for quote");
+        if (Is<Number>(list[0]) && As<Number>(list[0])->GetValue() != std::numeric_limits<int64_t>::min()) {
+            return MakeNumber(std::abs(As<Number>(list[0])->GetValue()));
         }
-        return list[0];
+        BigInt value = ToBigInt(list[0]);
+        return MakeNumber(value.IsNegative() ? -value : value);
     }
 };
 
 struct IsBoolean : Function {
-    std::shared_ptr<Object> operator()(std::shared_ptr<Object> obj) override {
-        std::vector<std::shared_ptr<Object>> list = CellToVector(obj);
+    std::shared_ptr<Object> operator()(Arguments list) override {
         if (IsListOfSize(list, 1) && IsListOfT<Symbol>(list) &&
-            (As<Symbol>(list[0])->GetName() == "#t" || As<Symbol>(list[0])->GetName() == "#f")) {
-            return std::make_shared<Symbol>("#t");
+            (As<Symbol>(list[0])->GetId() == kTrueSymbol || As<Symbol>(list[0])->GetId() == kFalseSymbol)) {
+            return MakeBoolean(true);
         }
-        return std::make_shared<Symbol>("#f");
+        return MakeBoolean(false);
     }
 };
 
 struct Not : Function {
-    std::shared_ptr<Object> operator()(std::shared_ptr<Object> obj) override {
-        std::vector<std::shared_ptr<Object>> list = CellToVector(obj);
+    std::shared_ptr<Object> operator()(Arguments list) override {
         if (!IsListOfSize(list, 1)) {
             throw RuntimeError("Wrong input");
         }
-        if (IsListOfT<Symbol>(list) && As<Symbol>(list[0])->GetName() == "#f") {
-            return std::make_shared<Symbol>("#t");
+        if (IsListOfT<Symbol>(list) && As<Symbol>(list[0])->GetId() == kFalseSymbol) {
+            return MakeBoolean(true);
         }
-        return std::make_shared<Symbol>("#f");
-    }
-};
-
-struct And : Function {
-    std::shared_ptr<Object> operator()(std::shared_ptr<Object> obj) override {
-        std::vector<std::shared_ptr<Object>> list = CellToVector(obj);
-        for (size_t i = 0; i < list.size(); ++i) {
-            list[i] = list[i]->Execute();
-            if (Is<Symbol>(list[i]) && As<Symbol>(list[i])->GetName() == "#f") {
-                return std::make_shared<Symbol>("#f");
-            }
-        }
-        if (list.empty()) {
-            return std::make_shared<Symbol>("#t");
-        }
-        return list.back();
-    }
-};
-
-struct Or : Function {
-    std::shared_ptr<Object> operator()(std::shared_ptr<Object> obj) override {
-        std::vector<std::shared_ptr<Object>> list = CellToVector(obj);
-        for (size_t i = 0; i < list.size(); ++i) {
-            list[i] = list[i]->Execute();
-            if (Is<Symbol>(list[i]) && As<Symbol>(list[i])->GetName() == "#t") {
-                return std::make_shared<Symbol>("#t");
-            }
-        }
-        if (list.empty()) {
-            return std::make_shared<Symbol>("#f");
-        }
-        return list.back();
+        return MakeBoolean(false);
     }
 };
 
 struct Pair : Function {
-    std::shared_ptr<Object> operator()(std::shared_ptr<Object> obj) override {
-        std::vector<std::shared_ptr<Object>> list = CellToVector(obj);
+    std::shared_ptr<Object> operator()(Arguments list) override {
         if (!IsListOfSize(list, 1)) {
             throw RuntimeError("Wrong input");
         }
-        list = CellToVector(list[0]->Execute());
-        if (IsListOfSize(list, 2)) {
-            return std::make_shared<Symbol>("#t");
-        }
-        return std::make_shared<Symbol>("#f");
+        return MakeBoolean(Is<Cell>(list[0]));
     }
 };
 
 struct Null : Function {
-    std::shared_ptr<Object> operator()(std::shared_ptr<Object> obj) override {
-        std::vector<std::shared_ptr<Object>> list = CellToVector(obj);
+    std::shared_ptr<Object> operator()(Arguments list) override {
         if (!IsListOfSize(list, 1)) {
             throw RuntimeError("Wrong input");
         }
-        if (list[0]->Execute() == nullptr) {
-            return std::make_shared<Symbol>("#t");
+        if (list[0] == nullptr) {
+            return MakeBoolean(true);
         }
-        return std::make_shared<Symbol>("#f");
+        return MakeBoolean(false);
     }
 };
 
 struct CheckList : Function {
-    std::shared_ptr<Object> operator()(std::shared_ptr<Object> obj) override {
-        std::vector<std::shared_ptr<Object>> list = CellToVector(obj);
+    std::shared_ptr<Object> operator()(Arguments list) override {
         if (!IsListOfSize(list, 1)) {
             throw RuntimeError("Wrong input");
         }
-        std::shared_ptr<Object> li = list[0]->Execute();
-        if (li == nullptr) {
-            return std::make_shared<Symbol>("#t");
-        }
-        while (Is<Cell>(As<Cell>(li)->GetSecond())) {
-            li = As<Cell>(li)->GetSecond();
-        }
-        if (As<Cell>(li)->GetSecond() == nullptr) {
-            return std::make_shared<Symbol>("#t");
+        // the fast pointer moves twice per step and meets the slow one on a circular list
+        const Object* fast = list[0].get();
+        const Object* slow = fast;
+        while (fast && fast->GetType() == Cell::kType) {
+            fast = static_cast<const Cell*>(fast)->GetSecond().get();
+            if (!fast || fast->GetType() != Cell::kType) {
+                break;
+            }
+            fast = static_cast<const Cell*>(fast)->GetSecond().get();
+            slow = static_cast<const Cell*>(slow)->GetSecond().get();
+            if (fast == slow) {
+                return MakeBoolean(false);
+            }
         }
-        return std::make_shared<Symbol>("#f");
+        return MakeBoolean(fast == nullptr);
     }
 };
 
 struct Cons : Function {
-    std::shared_ptr<Object> operator()(std::shared_ptr<Object> obj) override {
-        std::vector<std::shared_ptr<Object>> list = CellToVector(obj);
+    std::shared_ptr<Object> operator()(Arguments list) override {
         if (!IsListOfSize(list, 2)) {
             throw RuntimeError("Wrong input");
         }
-        return std::make_shared<Cell>(list[0], list[1]);
+        return MakeCell(list[0], list[1]);
     }
 };
 
 struct Car : Function {
-    std::shared_ptr<Object> operator()(std::shared_ptr<Object> obj) override {
-        if (As<Cell>(obj)->GetFirst() == nullptr || As<Cell>(obj)->GetSecond() != nullptr) {
-            throw RuntimeError("Wrong input");
-        }
-        std::shared_ptr<Object> li = As<Cell>(obj)->GetFirst()->Execute();
-        if (!Is<Cell>(li)) {
+    std::shared_ptr<Object> operator()(Arguments list) override {
+        if (!IsListOfSize(list, 1) || !Is<Cell>(list[0])) {
             throw RuntimeError("Wrong input");
         }
-        return As<Cell>(li)->GetFirst();
+        return As<Cell>(list[0])->GetFirst();
     }
 };
 
 struct Cdr : Function {
-    std::shared_ptr<Object> operator()(std::shared_ptr<Object> obj) override {
-        if (As<Cell>(obj)->GetFirst() == nullptr || As<Cell>(obj)->GetSecond() != nullptr) {
+    std::shared_ptr<Object> operator()(Arguments list) override {
+        if (!IsListOfSize(list, 1) || !Is<Cell>(list[0])) {
             throw RuntimeError("Wrong input");
         }
-        std::shared_ptr<Object> li = As<Cell>(obj)->GetFirst()->Execute();
-        if (!Is<Cell>(li)) {
-            throw RuntimeError("Wrong input");
-        }
-        return As<Cell>(li)->GetSecond();
+        return As<Cell>(list[0])->GetSecond();
     }
 };
 
 struct MakeList : Function {
-    std::shared_ptr<Object> operator()(std::shared_ptr<Object> obj) override {
-        return obj;
+    std::shared_ptr<Object> operator()(Arguments list) override {
+        std::shared_ptr<Object> ret;
+        for (size_t i = list.size(); i > 0; --i) {
+            ret = MakeCell(list[i - 1], ret);
+        }
+        return ret;
     }
 };
 
 struct ListRef : Function {
-    std::shared_ptr<Object> operator()(std::shared_ptr<Object> obj) override {
-        std::vector<std::shared_ptr<Object>> list = CellToVector(obj);
+    std::shared_ptr<Object> operator()(Arguments list) override {
         if (!IsListOfSize(list, 2)) {
             throw RuntimeError("Wrong input");
         }
-        if (!Is<Cell>(list[0]) || !Is<Number>(list[1])) {
-            throw RuntimeError("Wrong input");
-        }
-        size_t index = As<Number>(list[1])->GetValue();
-        list = CellToVector(list[0]->Execute());
-        if (index >= list.size()) {
+        auto rest = SkipCells(list[0], list[1]);
+        if (!Is<Cell>(rest)) {
             throw RuntimeError("Bad index in ListRef");
         }
-        return list[index];
+        return As<Cell>(rest)->GetFirst();
     }
 };
 
 struct ListTail : Function {
-    std::shared_ptr<Object> operator()(std::shared_ptr<Object> obj) override {
-        std::vector<std::shared_ptr<Object>> list = CellToVector(obj);
+    std::shared_ptr<Object> operator()(Arguments list) override {
         if (!IsListOfSize(list, 2)) {
             throw RuntimeError("Wrong input");
         }
-        if (!Is<Cell>(list[0]) || !Is<Number>(list[1])) {
-            throw RuntimeError("Wrong input");
-        }
-        size_t index = As<Number>(list[1])->GetValue();
-        list = CellToVector(list[0]->Execute());
-        if (index > list.size()) {
-            throw RuntimeError("Bad index in ListRef");
-        }
-        std::vector<std::shared_ptr<Object>> ret;
-        for (size_t i = index; i < list.size(); ++i) {
-            ret.push_back(list[i]);
-        }
-        return BuildList(ret, 0);
+        return SkipCells(list[0], list[1]);
     }
 };
 
 struct IsSymbol : Function {
-    std::shared_ptr<Object> operator()(std::shared_ptr<Object> obj) override {
-        std::vector<std::shared_ptr<Object>> list = CellToVector(obj);
-        for (size_t i = 0; i < list.size(); ++i) {
-            if (!list[i]) {
-                throw RuntimeError("Wronggg");
-            }
-            list[i] = list[i]->Execute();
-        }
+    std::shared_ptr<Object> operator()(Arguments list) override {
         if (IsListOfT<Symbol>(list) && IsListOfSize(list, 1)) {
-            return std::make_shared<Symbol>("#t");
+            return MakeBoolean(true);
         }
-        return std::make_shared<Symbol>("#f");
+        return MakeBoolean(false);
     }
 };
 
-struct Define : Function {
-    std::shared_ptr<Object> operator()(std::shared_ptr<Object> obj) override {
-        std::vector<std::shared_ptr<Object>> list = CellToVector(obj);
-        if (!IsListOfSize(list, 2)) {
-            throw SyntaxError("Wrong syntax in define");
-        }
-        if (!Is<Symbol>(list[0])) {
-            throw SyntaxError("Wrong syntax for variable name");
-        }
-        if (!list[1]) {
-            throw RuntimeError("Wronggg");
+struct SetCar : Function {
+    std::shared_ptr<Object> operator()(Arguments list) override {
+        if (!IsListOfSize(list, 2) || !Is<Cell>(list[0])) {
+            throw RuntimeError("Wrong input");
         }
-        list[1] = list[1]->Execute();
-        curr->vars_[As<Symbol>(list[0])->GetName()] = list[1];
+        As<Cell>(list[0])->SetFirst(list[1]);
         return nullptr;
     }
 };
 
-struct Set : Function {
-    std::shared_ptr<Object> operator()(std::shared_ptr<Object> obj) override {
-        std::vector<std::shared_ptr<Object>> list = CellToVector(obj);
-        if (!IsListOfSize(list, 2)) {
-            throw SyntaxError("Wrong syntax in set!");
+struct SetCdr : Function {
+    std::shared_ptr<Object> operator()(Arguments list) override {
+        if (!IsListOfSize(list, 2) || !Is<Cell>(list[0])) {
+            throw RuntimeError("Wrong input");
         }
-        if (!Is<Symbol>(list[0])) {
-            throw SyntaxError("Wrong syntax for variable name in set!");
+        As<Cell>(list[0])->SetSecond(list[1]);
+        return nullptr;
+    }
+};
+
+// Checks that index is a number in [0, size).
+size_t GetIndex(const std::shared_ptr<Object>& index, size_t size) {
+    if (!Is<Number>(index)) {
+        throw RuntimeError("Wrong type");
+    }
+    int64_t value = As<Number>(index)->GetValue();
+    if (value < 0 || static_cast<size_t>(value) >= size) {
+        throw RuntimeError("Bad index");
+    }
+    return value;
+}
+
+struct MakeVector : Function {
+    std::shared_ptr<Object> operator()(Arguments list) override {
+        if (list.empty() || list.size() > 2 || !Is<Number>(list[0])) {
+            throw RuntimeError("Wrong input for make-vector");
         }
-        if (curr->vars_.find(As<Symbol>(list[0])->GetName()) == curr->vars_.end()) {
-            throw NameError(std::string("No such variable: ") + As<Symbol>(list[0])->GetName());
+        int64_t size = As<Number>(list[0])->GetValue();
+        if (size < 0) {
+            throw RuntimeError("Wrong input for make-vector");
         }
-        if (!list[1]) {
-            throw RuntimeError("Wronggg");
+        auto fill = list.size() == 2 ? list[1] : MakeNumber(0);
+        std::vector<std::shared_ptr<Object>> elements;
+        try {
+            elements.assign(size, fill);
+        } catch (const std::bad_alloc&) {
+            throw RuntimeError("Wrong input for make-vector");
+        } catch (const std::length_error&) {
+            throw RuntimeError("Wrong input for make-vector");
         }
-        list[1] = list[1]->Execute();
-        curr->vars_[As<Symbol>(list[0])->GetName()] = list[1];
-        return nullptr;
+        return std::make_shared<Vector>(std::move(elements));
     }
 };
 
-struct If : Function {
-    std::shared_ptr<Object> operator()(std::shared_ptr<Object> obj) override {
-        std::vector<std::shared_ptr<Object>> list = CellToVector(obj);
-        if (IsListOfSize(list, 2)) {
-            if (!list[0]) {
-                throw RuntimeError("Wronggg");
-            }
-            list[0] = list[0]->Execute();
-            if (!(Is<Symbol>(list[0]) && (As<Symbol>(list[0])->GetName() == "#t" || As<Symbol>(list[0])->GetName() == "#f"))) {
-                throw SyntaxError("Wrong conition type in if");
-            }
-            if (As<Symbol>(list[0])->GetName() == "#t") {
-                if (!list[1]) {
-                    throw RuntimeError("Wronggg");
-                }
-                list[1] = list[1]->Execute();
-                return list[1];
-            }
-            else {
-                return nullptr;
-            }
+struct VectorOf : Function {
+    std::shared_ptr<Object> operator()(Arguments list) override {
+        return std::make_shared<Vector>(std::vector(list.begin(), list.end()));
+    }
+};
+
+struct IsVector : Function {
+    std::shared_ptr<Object> operator()(Arguments list) override {
+        if (!IsListOfSize(list, 1)) {
+            throw RuntimeError("Wrong input");
         }
-        else if (IsListOfSize(list, 3)) {
-            if (!list[0]) {
-                throw RuntimeError("Wronggg");
-            }
-            list[0] = list[0]->Execute();
-            if (!(Is<Symbol>(list[0]) && (As<Symbol>(list[0])->GetName() == "#t" || As<Symbol>(list[0])->GetName() == "#f"))) {
-                throw SyntaxError("Wrong condition type in if");
-            }
-            if (As<Symbol>(list[0])->GetName() == "#t") {
-                if (!list[1]) {
-                    throw RuntimeError("Wronggg");
-                }
-                list[1] = list[1]->Execute();
-                return list[1];
-            }
-            else {
-                if (!list[2]) {
-                    throw RuntimeError("Wronggg");
-                }
-                list[2] = list[2]->Execute();
-                return list[2];
-            }
+        return MakeBoolean(Is<Vector>(list[0]));
+    }
+};
+
+struct VectorLength : Function {
+    std::shared_ptr<Object> operator()(Arguments list) override {
+        if (!IsListOfSize(list, 1) || !Is<Vector>(list[0])) {
+            throw RuntimeError("Wrong input for vector-length");
         }
-        else {
-            throw SyntaxError("Wrong input in if");
+        return MakeNumber(As<Vector>(list[0])->GetElements().size());
+    }
+};
+
+struct VectorRef : Function {
+    std::shared_ptr<Object> operator()(Arguments list) override {
+        if (!IsListOfSize(list, 2) || !Is<Vector>(list[0])) {
+            throw RuntimeError("Wrong input for vector-ref");
         }
+        auto& elements = As<Vector>(list[0])->GetElements();
+        return elements[GetIndex(list[1], elements.size())];
     }
 };
 
-struct SetCar : Function {
-    std::shared_ptr<Object> operator()(std::shared_ptr<Object> obj) override {
-        std::vector<std::shared_ptr<Object>> list = CellToVector(obj);
-        for (size_t i = 0; i < list.size(); ++i) {
-            if (!list[i]) {
-                throw RuntimeError("Wronggg");
-            }
-            list[i] = list[i]->Execute();
+struct VectorSet : Function {
+    std::shared_ptr<Object> operator()(Arguments list) override {
+        if (!IsListOfSize(list, 3) || !Is<Vector>(list[0])) {
+            throw RuntimeError("Wrong input for vector-set!");
         }
-        As<Cell>(list[0])->SetFirst(As<Cell>(list[1]));
+        auto& elements = As<Vector>(list[0])->GetElements();
+        elements[GetIndex(list[1], elements.size())] = list[2];
         return nullptr;
     }
 };
 
-struct MakeLambda : Function {
-    std::shared_ptr<Object> operator()(std::shared_ptr<Object> obj) override {
-        std::vector<std::shared_ptr<Object>> list = CellToVector(obj);
-        if (list.size() < 2) {
-            throw SyntaxError("alarm");
+struct VectorToList : Function {
+    std::shared_ptr<Object> operator()(Arguments list) override {
+        if (!IsListOfSize(list, 1) || !Is<Vector>(list[0])) {
+            throw RuntimeError("Wrong input for vector->list");
         }
-        if (!Is<Cell>(list[1])) {
-            throw SyntaxError("alarm-alarm");
+        const auto& elements = As<Vector>(list[0])->GetElements();
+        std::shared_ptr<Object> ret;
+        for (size_t i = elements.size(); i > 0; --i) {
+            ret = MakeCell(elements[i - 1], ret);
         }
-        std::vector<std::shared_ptr<Object>> l_args = CellToVector(list[1]);
-        std::vector<std::shared_ptr<Object>> l_body;
-        for (size_t i = 2; i < list.size(); ++i) {
-            l_body.push_back(list[i]);
+        return ret;
+    }
+};
+
+struct ListToVector : Function {
+    std::shared_ptr<Object> operator()(Arguments list) override {
+        if (!IsListOfSize(list, 1)) {
+            throw RuntimeError("Wrong input for list->vector");
+        }
+        std::vector<std::shared_ptr<Object>> elements;
+        auto rest = list[0];
+        while (Is<Cell>(rest)) {
+            elements.push_back(As<Cell>(rest)->GetFirst());
+            rest = As<Cell>(rest)->GetSecond();
         }
-        std::vector<std::string> l_vars;
-        for (auto i : l_args) {
-            l_vars.push_back(i->ToString());
+        if (rest) {
+            throw RuntimeError("Wrong input for list->vector");
         }
-        return std::make_shared(l_body, l_vars);
+        return std::make_shared<Vector>(std::move(elements));
     }
 };
 
-struct SetCdr : Function {
-    std::shared_ptr<Object> operator()(std::shared_ptr<Object> obj) override {
-        auto first = As<Cell>(obj)->GetFirst();
-        first = first->Execute();
-        auto second = As<Cell>(As<Cell>(obj)->GetSecond())->GetFirst();
-        second = second->Execute();
+template <class F>
+std::shared_ptr<Object> MakeBuiltin() {
+    return std::make_shared<Builtin>(std::make_shared<F>());
+}
 
-        As<Cell>(first)->SetSecond(second);
+// keyed by the interned name, the table of names is created on first use
+std::unordered_map<SymbolId, std::shared_ptr<Object>> k_functions{
+    {Intern("number?"), MakeBuiltin<IsNumber>()},
+    {Intern(">"), MakeBuiltin<Compare<Greater>>()},
+    {Intern("<"), MakeBuiltin<Compare<Less>>()},
+    {Intern(">="), MakeBuiltin<Compare<GreaterEqual>>()},
+    {Intern("<="), MakeBuiltin<Compare<LessEqual>>()},
+    {Intern("="), MakeBuiltin<Compare<Equal>>()},
+    {Intern("+"), MakeBuiltin<DefFirst<Sum>>()},
+    {Intern("*"), MakeBuiltin<DefFirst<Mul>>()},
+    {Intern("-"), MakeBuiltin<NotDefFirst<Minus>>()},
+    {Intern("/"), MakeBuiltin<NotDefFirst<Devide>>()},
+    {Intern("max"), MakeBuiltin<NotDefFirst<Max>>()},
+    {Intern("min"), MakeBuiltin<NotDefFirst<Min>>()},
+    {Intern("abs"), MakeBuiltin<Abs>()},
+    {Intern("boolean?"), MakeBuiltin<IsBoolean>()},
+    {Intern("not"), MakeBuiltin<Not>()},
+    {Intern("pair?"), MakeBuiltin<Pair>()},
+    {Intern("null?"), MakeBuiltin<Null>()},
+    {Intern("list?"), MakeBuiltin<CheckList>()},
+    {Intern("cons"), MakeBuiltin<Cons>()},
+    {Intern("car"), MakeBuiltin<Car>()},
+    {Intern("cdr"), MakeBuiltin<Cdr>()},
+    {Intern("list"), MakeBuiltin<MakeList>()},
+    {Intern("list-ref"), MakeBuiltin<ListRef>()},
+    {Intern("list-tail"), MakeBuiltin<ListTail>()},
+    {Intern("symbol?"), MakeBuiltin<IsSymbol>()},
+    {Intern("set-car!"), MakeBuiltin<SetCar>()},
+    {Intern("set-cdr!"), MakeBuiltin<SetCdr>()},
+    {Intern("make-vector"), MakeBuiltin<MakeVector>()},
+    {Intern("vector"), MakeBuiltin<VectorOf>()},
+    {Intern("vector?"), MakeBuiltin<IsVector>()},
+    {Intern("vector-length"), MakeBuiltin<VectorLength>()},
+    {Intern("vector-ref"), MakeBuiltin<VectorRef>()},
+    {Intern("vector-set!"), MakeBuiltin<VectorSet>()},
+    {Intern("vector->list"), MakeBuiltin<VectorToList>()},
+    {Intern("list->vector"), MakeBuiltin<ListToVector>()}};
+
+std::shared_ptr<Object> FindBuiltin(SymbolId name) {
+    auto it = k_functions.find(name);
+    if (it == k_functions.end()) {
         return nullptr;
     }
-};
+    return it->second;
+}
 
-std::unordered_map<std::string, std::shared_ptr<Function>> k_functions{
-    {"number?", std::make_shared<IsNumber>()},
-    {">", std::make_shared<Compare<Greater>>()},
-    {"<", std::make_shared<Compare<Less>>()},
-    {">=", std::make_shared<Compare<GreaterEqual>>()},
-    {"<=", std::make_shared<Compare<LessEqual>>()},
-    {"=", std::make_shared<Compare<Equal>>()},
-    {"+", std::make_shared<DefFirst<Sum>>()},
-    {"*", std::make_shared<DefFirst<Mul>>()},
-    {"-", std::make_shared<NotDefFirst<Minus>>()},
-    {"/", std::make_shared<NotDefFirst<Devide>>()},
-    {"max", std::make_shared<NotDefFirst<Max>>()},
-    {"min", std::make_shared<NotDefFirst<Min>>()},
-    {"abs", std::make_shared<Abs>()},
-    {"quote", std::make_shared<Quote>()},
-    {"boolean?", std::make_shared<IsBoolean>()},
-    {"not", std::make_shared<Not>()},
-    {"and", std::make_shared<And>()},
-    {"or", std::make_shared<Or>()},
-    {"pair?", std::make_shared<Pair>()},
-    {"null?", std::make_shared<Null>()},
-    {"list?", std::make_shared<CheckList>()},
-    {"cons", std::make_shared<Cons>()},
-    {"car", std::make_shared<Car>()},
-    {"cdr", std::make_shared<Cdr>()},
-    {"list", std::make_shared<MakeList>()},
-    {"list-ref", std::make_shared<ListRef>()},
-    {"list-tail", std::make_shared<ListTail>()},
-    {"symbol?", std::make_shared<IsSymbol>()},
-    {"define", std::make_shared<Define>()},
-    {"set!", std::make_shared<Set>()},
-    {"if", std::make_shared<If>()},
-    {"set-car!", std::make_shared<SetCar>()},
-    {"set-cdr!", std::make_shared<SetCdr>()},
-    {"lambda", std::make_shared<MakeLambda>()}
 
-};
+// The first block of the arena of a form. Most forms are short, a longer one gets blocks of
+// twice the size each. Every form of a batch gets an arena of its own, so that its memory is
+// reused by the next form while it is still in cache.
+const size_t kFormArenaBytes = 1024;
 
-std::string Interpreter::Run(const std::string& str) {
-    std::stringstream ss{ str };
-    Tokenizer tokenizer(&ss);
-    auto obj = Read(&tokenizer);
+std::shared_ptr<Object> Interpreter::Parse(const std::string& str) {
+    Tokenizer tokenizer(str);
+    // the program goes away with the arena when Run returns or the parse cache drops it, the
+    // compiler copies the constants the program may keep
+    ArenaAllocator<Object> arena(new Arena(kFormArenaBytes));
+    auto obj = Read(&tokenizer, arena);
     if (!tokenizer.IsEnd()) {
         throw SyntaxError("Wrong input");
     }
-    if (!obj) {
+    return obj;
+}
+
+Evaluator DefaultEvaluator() {
+    const char* name = std::getenv("SCHEME_EVALUATOR");
+    if (name && std::strcmp(name, "bytecode") == 0) {
+        return Evaluator::kBytecode;
+    }
+    return Evaluator::kTree;
+}
+
+NodePtr Interpreter::Compile(const std::shared_ptr<Object>& program) const {
+    if (evaluator_ == Evaluator::kBytecode) {
+        return CompileBytecode(program, call_depth_limit_);
+    }
+    return ::Compile(program);
+}
+
+CollectStats Interpreter::CollectGarbage() {
+    auto stats = CollectCycles();
+    collect_threshold_ = std::max(kMinCollectThreshold, 2 * (stats.nodes - stats.freed));
+    return stats;
+}
+
+std::string Interpreter::Evaluate(std::shared_ptr<Object> program) {
+    if (!program) {
         throw RuntimeError("You typed nothing");
     }
-    obj = obj->Execute();
+    return Evaluate(*Compile(program));
+}
+
+std::string Interpreter::Evaluate(Node& code) {
+    if (CountNodes() > collect_threshold_) {
+        CollectGarbage();
+    }
+    auto obj = code.Eval(nullptr);
     if (obj == nullptr) {
         return "()";
     }
@@ -633,54 +642,57 @@ std::string Interpreter::Run(const std::string& str) {
     return obj->ToString();
 }
 
-std::shared_ptr<Object> Number::Execute() {
-    return this->Clone();
-}
-
-std::shared_ptr<Object> Symbol::Execute() {
-    std::string name = GetName();
-    if (name == "#f" || name == "#t") {
-        return this->Clone();
+std::string Interpreter::Run(const std::string& str) {
+    auto* program = parse_cache_.Find(str);
+    if (!program) {
+        auto obj = Parse(str);
+        if (!obj || !(program = parse_cache_.Insert(str, obj))) {
+            return Evaluate(obj);
+        }
     }
-    if (curr->vars_.find(name) == curr->vars_.end()) {
-        throw NameError(std::string("No such variable: ") + name);
+    if (!program->code) {
+        program->code = Compile(program->form);
     }
-    return curr->vars_.find(name)->second;
+    // the cache entry may be evicted while the program runs
+    auto code = program->code;
+    return Evaluate(*code);
 }
 
-std::shared_ptr<Object> Cell::Execute() {
-    if (first_ == nullptr) {
-        throw RuntimeError("No function was typed");
+std::vector<std::string> Interpreter::RunAll(const std::string& str) {
+    Tokenizer tokenizer(str);
+    std::vector<std::string> results;
+    while (!tokenizer.IsEnd()) {
+        ArenaAllocator<Object> arena(new Arena(kFormArenaBytes));
+        results.push_back(Evaluate(Read(&tokenizer, arena)));
     }
+    return results;
+}
 
-    if (Is<Cell>(first_) && Is<Symbol>(As<Cell>(first_)->GetFirst()) && As<Symbol>(As<Cell>(first_)->GetFirst())->GetName() == "lambda") {
-        arguments = CellToVector(second_);
-        std::shared_ptr<Object> lmbd = (*k_functions["lambda"])(first_));
-        return lmbd->Execute();
+std::vector<std::string> Interpreter::RunAll(ProgramImage* image) {
+    std::vector<std::string> results;
+    while (!image->IsEnd()) {
+        ArenaAllocator<Object> arena(new Arena(kFormArenaBytes));
+        results.push_back(Evaluate(Read(image, arena)));
     }
+    return results;
+}
 
-    if (!Is<Symbol>(first_)) {
-        throw RuntimeError("Wrong name of function");
+void Interpreter::RunStream(std::istream* in, std::ostream* out) {
+    Tokenizer tokenizer(in);
+    while (!tokenizer.IsEnd()) {
+        ArenaAllocator<Object> arena(new Arena(kFormArenaBytes));
+        *out << Evaluate(Read(&tokenizer, arena)) << '\n';
     }
-    std::string fun_name = As<Symbol>(first_)->GetName();
-    
-    /*if (curr->vars_.find(fun_name) != curr->vars_.end()) {
-        auto input = CellToVector(second_);
-        auto lambda = As<Lambda>(curr->vars_[fun_name]);
-        for (size_t i = 0; i < lambda->GetVars().size(); ++i) {
-            lambda->GetScope()->vars_[lambda->GetVars()[i]] = input[i]->Execute();
-        }
-        return lambda->Execute();
-    }*/
-    if (k_functions.find(fun_name) == k_functions.end()) {
-        throw RuntimeError("No such function");
-    }
-    if (second_ != nullptr && !Is<Cell>(second_)) {
-        throw RuntimeError("Shit happens");
-    }
-    if (fun_name == "define") {
-        (*k_functions[fun_name])(second_);
-        return first_;
-    }
-    return (*k_functions[fun_name])(second_);
+}
+
+std::shared_ptr<Object> Number::Execute() {
+    return Self();
+}
+
+std::shared_ptr<Object> Symbol::Execute() {
+    return Compile(Self())->Eval(nullptr);
+}
+
+std::shared_ptr<Object> Cell::Execute() {
+    return Compile(Self())->Eval(nullptr);
 }
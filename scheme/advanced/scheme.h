@@ -1,14 +1,77 @@
 #pragma once
 
+#include <istream>
+#include <ostream>
 #include <string>
+#include <vector>
 #include <parser.h>
+#include <parse_cache.h>
+#include <program_image.h>
+#include <collector.h>
 #include <unordered_map>
 
+// Both evaluate the compiled nodes, see compiler.h and vm.h.
+enum class Evaluator {
+    kTree,
+    kBytecode,
+};
+
+// kBytecode if the environment variable SCHEME_EVALUATOR is "bytecode", kTree otherwise. This
+// way the tests run on either.
+Evaluator DefaultEvaluator();
+
 class Interpreter {
 public:
-    Interpreter() {
-        lambdas.clear();
-        curr->vars_.clear();
+    Interpreter() : Interpreter(0) {
+    }
+
+    // Keeps up to parse_cache_capacity parsed programs, so that running the same text again
+    // skips tokenizing, parsing and compiling. See ParseCache for the caveat.
+    //
+    // The bytecode machine keeps the calls on the heap and throws RuntimeError once they nest
+    // deeper than call_depth_limit. The tree evaluator recurses on the native stack instead.
+    explicit Interpreter(size_t parse_cache_capacity, Evaluator evaluator = DefaultEvaluator(),
+                         size_t call_depth_limit = kDefaultCallDepthLimit)
+        : parse_cache_(parse_cache_capacity),
+          collect_threshold_(kMinCollectThreshold),
+          evaluator_(evaluator),
+          call_depth_limit_(call_depth_limit) {
+        globals.clear();
     }
+
     std::string Run(const std::string&);
+
+    // Evaluates every top-level form of the program in order and returns their results.
+    // Stops at the first error, which is rethrown.
+    std::vector<std::string> RunAll(const std::string&);
+
+    // Same for a program compiled in advance, see CompileProgram.
+    std::vector<std::string> RunAll(ProgramImage* image);
+
+    // Evaluates the forms as they arrive from the stream and writes each result on its own
+    // line. Stops at the end of the stream or at the first error, which is rethrown.
+    void RunStream(std::istream* in, std::ostream* out);
+
+    // Frees garbage cycles now. This also happens before evaluating a form whenever the
+    // number of nodes has doubled since the last collection.
+    CollectStats CollectGarbage();
+
+    ParseCache::Stats GetParseCacheStats() const {
+        return parse_cache_.GetStats();
+    }
+
+private:
+    static constexpr size_t kMinCollectThreshold = 1 << 16;
+    // a few hundred megabytes of frames
+    static constexpr size_t kDefaultCallDepthLimit = 1 << 22;
+
+    std::shared_ptr<Object> Parse(const std::string&);
+    std::string Evaluate(std::shared_ptr<Object> program);
+    std::string Evaluate(Node& code);
+    NodePtr Compile(const std::shared_ptr<Object>& program) const;
+
+    ParseCache parse_cache_;
+    size_t collect_threshold_;
+    Evaluator evaluator_;
+    size_t call_depth_limit_;
 };
@@ -3,6 +3,17 @@ add_library(scheme_advanced
     parser.cpp
     scheme.cpp
     object.cpp
+    mapped_file.cpp
+    incremental_tokenizer.cpp
+    arena.cpp
+    parse_cache.cpp
+    program_image.cpp
+    symbol_table.cpp
+    collector.cpp
+    cell_pool.cpp
+    bigint.cpp
+    compiler.cpp
+    vm.cpp
     
     # maybe more .cpp files here
 )
@@ -0,0 +1,60 @@
+#include <symbol_table.h>
+
+#include <deque>
+#include <unordered_map>
+
+namespace {
+
+class SymbolTable {
+public:
+    SymbolTable() {
+        // in the order of the k*Symbol constants
+        for (auto name : {"#f", "#t", "quote", ".", "define", "lambda"}) {
+            Intern(name);
+        }
+    }
+
+    SymbolId Intern(std::string_view name) {
+        auto it = ids_.find(name);
+        if (it != ids_.end()) {
+            return it->second;
+        }
+        SymbolId id = names_.size();
+        // deque never moves its elements, so the key may point into the stored name
+        names_.emplace_back(name);
+        ids_.emplace(names_.back(), id);
+        return id;
+    }
+
+    const std::string& GetName(SymbolId id) const {
+        return names_[id];
+    }
+
+    size_t Size() const {
+        return names_.size();
+    }
+
+private:
+    std::deque<std::string> names_;
+    std::unordered_map<std::string_view, SymbolId> ids_;
+};
+
+// Created on first use, so that static tables in other files may intern names.
+SymbolTable& GetSymbolTable() {
+    static SymbolTable table;
+    return table;
+}
+
+}  // namespace
+
+SymbolId Intern(std::string_view name) {
+    return GetSymbolTable().Intern(name);
+}
+
+const std::string& GetSymbolName(SymbolId id) {
+    return GetSymbolTable().GetName(id);
+}
+
+size_t SymbolCount() {
+    return GetSymbolTable().Size();
+}
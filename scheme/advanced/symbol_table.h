@@ -0,0 +1,26 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+// Every distinct symbol name is stored once in a process-wide table and referred to by its
+// index. Ids compare and hash as integers, and names are never freed.
+using SymbolId = uint32_t;
+
+// Symbols the interpreter itself looks for, interned before anything else.
+constexpr SymbolId kFalseSymbol = 0;
+constexpr SymbolId kTrueSymbol = 1;
+constexpr SymbolId kQuoteSymbol = 2;
+constexpr SymbolId kDotSymbol = 3;
+constexpr SymbolId kDefineSymbol = 4;
+constexpr SymbolId kLambdaSymbol = 5;
+
+// Returns the id of the name, adding it to the table if it is new.
+SymbolId Intern(std::string_view name);
+
+// The reference stays valid for the lifetime of the process.
+const std::string& GetSymbolName(SymbolId id);
+
+// Number of interned symbols, ids are below it.
+size_t SymbolCount();
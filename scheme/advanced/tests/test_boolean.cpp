@@ -58,3 +58,14 @@ TEST_CASE_METHOD(SchemeTest, "OrSyntax") {
     ExpectEq("(or #f (< 2 1))", "#f");
     ExpectEq("(or #f 1)", "1");
 }
+
+TEST_CASE("Predicates return the shared booleans") {
+    for (std::string predicate : {"(number? 1)", "(< 1 2)", "(not 1)", "(and 1 #f)", "(or #f #t)",
+                                  "(pair? '(1 . 2))", "(null? '())", "(list? 1)", "(boolean? #t)"}) {
+        Tokenizer tokenizer{std::string_view(predicate)};
+        auto result = Read(&tokenizer)->Execute();
+        REQUIRE(Is<Symbol>(result));
+        REQUIRE((result == MakeBoolean(true) || result == MakeBoolean(false)));
+        REQUIRE(result.use_count() == 0);
+    }
+}
@@ -0,0 +1,91 @@
+#include "scheme_test.h"
+
+#include <compiler.h>
+#include <vm.h>
+
+#include <string>
+#include <vector>
+
+TEST_CASE("Evaluators agree") {
+    const std::vector<std::string> program = {
+        "(define (fib n) (if (< n 2) n (+ (fib (- n 1)) (fib (- n 2)))))",
+        "(fib 15)",
+        "(define (make-counter) (define n 0) (lambda () (set! n (+ n 1)) n))",
+        "(define c (make-counter))",
+        "(c)",
+        "(c)",
+        "(and 1 (or #f 2) (if #f 3))",
+        "((lambda (x y) (cons y x)) 1 '(2))",
+        "(define plus +)",
+        "(define (+ a b) (plus a b 1))",
+        "(+ 1 2)",
+    };
+    Interpreter tree(0, Evaluator::kTree);
+    std::vector<std::string> expected;
+    for (const auto& form : program) {
+        expected.push_back(tree.Run(form));
+    }
+    Interpreter bytecode(0, Evaluator::kBytecode);
+    for (size_t i = 0; i < program.size(); ++i) {
+        REQUIRE(bytecode.Run(program[i]) == expected[i]);
+    }
+}
+
+TEST_CASE("Bytecode calls do not use the native stack") {
+    Interpreter interpreter(0, Evaluator::kBytecode);
+    interpreter.Run("(define (loop n acc) (if (= n 0) acc (loop (- n 1) (+ acc 1))))");
+    REQUIRE(interpreter.Run("(loop 1000000 0)") == "1000000");
+    interpreter.Run("(define (depth n) (if (= n 0) 0 (+ 1 (depth (- n 1)))))");
+    REQUIRE(interpreter.Run("(depth 100000)") == "100000");
+}
+
+TEST_CASE("Bytecode recursion is limited by memory") {
+    Interpreter interpreter(0, Evaluator::kBytecode);
+    interpreter.Run("(define (build n) (if (= n 0) '() (cons n (build (- n 1)))))");
+    interpreter.Run("(define (length l) (if (null? l) 0 (+ 1 (length (cdr l)))))");
+    REQUIRE(interpreter.Run("(length (build 1000000))") == "1000000");
+}
+
+TEST_CASE("Bytecode recursion depth limit") {
+    Interpreter interpreter(0, Evaluator::kBytecode, 1000);
+    interpreter.Run("(define (depth n) (if (= n 0) 0 (+ 1 (depth (- n 1)))))");
+    REQUIRE(interpreter.Run("(depth 999)") == "999");
+    REQUIRE_THROWS_AS(interpreter.Run("(depth 1000)"), RuntimeError);
+    interpreter.Run("(define (forever) (+ 1 (forever)))");
+    REQUIRE_THROWS_AS(interpreter.Run("(forever)"), RuntimeError);
+    // tail calls take no depth
+    interpreter.Run("(define (loop n) (if (= n 0) 'done (loop (- n 1))))");
+    REQUIRE(interpreter.Run("(loop 100000)") == "done");
+    REQUIRE(interpreter.Run("(depth 10)") == "10");
+}
+
+TEST_CASE("Bytecode errors") {
+    Interpreter interpreter(0, Evaluator::kBytecode);
+    REQUIRE_THROWS_AS(interpreter.Run("(if 1 2 3)"), SyntaxError);
+    REQUIRE_THROWS_AS(interpreter.Run("(set! undefined 1)"), NameError);
+    REQUIRE_THROWS_AS(interpreter.Run("((lambda (x) x))"), RuntimeError);
+    REQUIRE_THROWS_AS(interpreter.Run("(1 2)"), RuntimeError);
+    // the machine starts afresh after an error
+    REQUIRE(interpreter.Run("((lambda (x) (* x x)) 7)") == "49");
+}
+
+// Runs a program that fills the value stack while the caller's arguments are on it.
+struct NestedRun : Function {
+    std::shared_ptr<Object> operator()(Arguments args) override {
+        std::string program = "(+";
+        for (int i = 0; i < 10000; ++i) {
+            program += " 1";
+        }
+        program += ")";
+        Tokenizer tokenizer{std::string_view(program)};
+        auto sum = CompileBytecode(Read(&tokenizer), 100)->Eval(nullptr);
+        return MakeCell(args[0], sum);
+    }
+};
+
+TEST_CASE("Bytecode runs nested in a call") {
+    Interpreter interpreter(0, Evaluator::kBytecode);
+    globals[Intern("nested-run")] = std::make_shared<Builtin>(std::make_shared<NestedRun>());
+    REQUIRE(interpreter.Run("((lambda (x) (nested-run (+ x 1))) 41)") == "(42 . 10000)");
+    REQUIRE(interpreter.Run("(+ 1 ((lambda () (car (nested-run 2)))))") == "3");
+}
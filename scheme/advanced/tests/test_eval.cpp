@@ -1,5 +1,7 @@
 #include "scheme_test.h"
 
+#include <compiler.h>
+
 TEST_CASE_METHOD(SchemeTest, "Quote") {
     ExpectEq("(quote (1 2))", "(1 2)");
     ExpectEq("'(1 2)", "(1 2)");
@@ -11,3 +13,95 @@ TEST_CASE_METHOD(SchemeTest, "Be careful") {
     ExpectRuntimeError("('() ())");
     ExpectEq("'(())", "(())");
 }
+
+TEST_CASE("Constants do not keep the parsed form") {
+    std::weak_ptr<Object> parsed;
+    {
+        ArenaAllocator<Object> arena(new Arena(0));
+        Tokenizer tokenizer{std::string_view("(define kept-list '(1 2 . 3000))")};
+        auto form = Read(&tokenizer, arena);
+        auto quote = As<Cell>(As<Cell>(As<Cell>(form)->GetSecond())->GetSecond())->GetFirst();
+        parsed = As<Cell>(As<Cell>(quote)->GetSecond())->GetFirst();
+        Compile(form)->Eval(nullptr);
+    }
+    // nothing refers to the nodes of the form, so its arena is gone too
+    REQUIRE(parsed.expired());
+    auto list = As<Cell>(LookUpGlobal(Intern("kept-list")));
+    REQUIRE(As<Number>(list->GetFirst())->GetValue() == 1);
+    REQUIRE(As<Number>(As<Cell>(list->GetSecond())->GetSecond())->GetValue() == 3000);
+    globals.erase(Intern("kept-list"));
+}
+
+TEST_CASE("Parse cache") {
+    Interpreter interpreter(2);
+    REQUIRE(interpreter.Run("(+ 1 2)") == "3");
+    REQUIRE(interpreter.Run("(+ 1 2)") == "3");
+    REQUIRE(interpreter.Run("'(1 2)") == "(1 2)");
+    auto stats = interpreter.GetParseCacheStats();
+    REQUIRE(stats.hits == 1);
+    REQUIRE(stats.misses == 2);
+    REQUIRE(stats.size == 2);
+
+    // "(+ 1 2)" is the least recently used one and makes room for the new program
+    REQUIRE(interpreter.Run("(* 2 3)") == "6");
+    REQUIRE(interpreter.Run("'(1 2)") == "(1 2)");
+    REQUIRE(interpreter.Run("(+ 1 2)") == "3");
+    stats = interpreter.GetParseCacheStats();
+    REQUIRE(stats.hits == 2);
+    REQUIRE(stats.misses == 4);
+    REQUIRE(stats.size == 2);
+
+    // cached programs still see the current state
+    interpreter.Run("(define x 1)");
+    REQUIRE(interpreter.Run("x") == "1");
+    interpreter.Run("(set! x 5)");
+    REQUIRE(interpreter.Run("x") == "5");
+}
+
+TEST_CASE("Parse cache is off by default") {
+    Interpreter interpreter;
+    interpreter.Run("(+ 1 2)");
+    interpreter.Run("(+ 1 2)");
+    auto stats = interpreter.GetParseCacheStats();
+    REQUIRE(stats.hits == 0);
+    REQUIRE(stats.misses == 0);
+    REQUIRE(stats.size == 0);
+}
+
+TEST_CASE("Run several forms") {
+    Interpreter interpreter;
+    std::vector<std::string> expected = {"define", "1", "(1 2)", "3"};
+    REQUIRE(interpreter.RunAll("(define x 1) x\n'(1 2)\n (+ x 2)  ") == expected);
+    REQUIRE(interpreter.RunAll("").empty());
+    REQUIRE(interpreter.RunAll(" \n").empty());
+    REQUIRE_THROWS_AS(interpreter.RunAll("1 (+ 1"), SyntaxError);
+    REQUIRE_THROWS_AS(interpreter.RunAll("1 )"), SyntaxError);
+
+    std::stringstream in("(define y 2)\n(* y 3) y\n");
+    std::stringstream out;
+    interpreter.RunStream(&in, &out);
+    REQUIRE(out.str() == "define\n6\n2\n");
+}
+
+TEST_CASE("Run a compiled program") {
+    auto image = CompileProgram("(define x 2) (* x 21) '(1 . 2)");
+    ProgramImage program{std::string_view(image)};
+    Interpreter interpreter;
+    std::vector<std::string> expected = {"define", "42", "(1 . 2)"};
+    REQUIRE(interpreter.RunAll(&program) == expected);
+}
+
+TEST_CASE_METHOD(SchemeTest, "Deeply nested expressions") {
+    auto nested = [](int depth) {
+        std::string form;
+        for (int i = 0; i < depth; ++i) {
+            form += "(+ 1 ";
+        }
+        return form + "0" + std::string(depth, ')');
+    };
+    ExpectEq(nested(1000), "1000");
+    ExpectRuntimeError(nested(1001));
+    ExpectRuntimeError(nested(100000));
+    ExpectRuntimeError("(define (f) " + nested(100000) + ")");
+    ExpectEq(nested(10), "10");
+}
@@ -6,10 +6,10 @@
 #include <catch.hpp>
 
 TEST_CASE_METHOD(SchemeTest, "SimpleLambda") {
-    //ExpectEq("((lambda (x) (+ 1 x)) 5)", "6");
+    ExpectEq("((lambda (x) (+ 1 x)) 5)", "6");
 }
 
-/*TEST_CASE_METHOD(SchemeTest, "LambdaBodyHasImplicitBegin") {
+TEST_CASE_METHOD(SchemeTest, "LambdaBodyHasImplicitBegin") {
     ExpectNoError("(define test (lambda (x) (set! x (* x 2)) (+ 1 x)))");
     ExpectEq("(test 20)", "41");
 }
@@ -114,6 +114,16 @@ TEST_CASE_METHOD(SchemeTest, "Deep recursion") {
     }
 }
 
+TEST_CASE_METHOD(SchemeTest, "Tail calls") {
+    ExpectNoError("(define (loop n acc) (if (= n 0) acc (loop (- n 1) (+ acc 1))))");
+    ExpectEq("(loop 1000000 0)", "1000000");
+    ExpectNoError("(define (even? n) (or (= n 0) (odd? (- n 1))))");
+    ExpectNoError("(define (odd? n) (and (not (= n 0)) (even? (- n 1))))");
+    ExpectEq("(even? 1000001)", "#f");
+    ExpectNoError("(define (count n) (define (next) (count (- n 1))) (if (= n 0) 'done (next)))");
+    ExpectEq("(count 1000000)", "done");
+}
+
 TEST_CASE_METHOD(SchemeTest, "Redefinition") {
     ExpectEq("(+ 1 2 -3)", "0");
     ExpectNoError("(define plus +)");
@@ -134,4 +144,36 @@ TEST_CASE_METHOD(SchemeTest, "Redefinition and scoping") {
     ExpectEq("((bar) 1 2)", "-1");
     ExpectEq("((foobar) 1 2)", "3");
     ExpectEq("(+ 1 2 -3)", "0");
-}*/
+}
+
+TEST_CASE_METHOD(SchemeTest, "Variables of outer lambdas") {
+    ExpectNoError("(define (adder a) (lambda (b) (lambda (c) (set! a (+ a 1)) (+ a b c))))");
+    ExpectNoError("(define add (adder 1))");
+    ExpectEq("((add 10) 100)", "112");
+    ExpectEq("((add 10) 100)", "113");
+    ExpectEq("((lambda (x x) x) 1 2)", "2");
+}
+
+TEST_CASE_METHOD(SchemeTest, "Internal definitions before they are evaluated") {
+    ExpectNoError("(define (early) (define a b) (define b 1) a)");
+    ExpectNameError("(early)");
+    ExpectNoError("(define (late) (define (get) b) (define b 1) (get))");
+    ExpectEq("(late)", "1");
+    ExpectNoError("(define (assign) (set! b 2) (define b 1) b)");
+    ExpectNameError("(assign)");
+}
+
+TEST_CASE("Closure cycles are collected") {
+    Interpreter interpreter;
+    interpreter.CollectGarbage();
+    size_t before = CountNodes();
+    // the frame of counter holds next, which holds the frame
+    interpreter.Run("(define (counter) (define n 0) (define (next) (set! n (+ n 1)) n) next)");
+    interpreter.Run("(define c (counter))");
+    REQUIRE(interpreter.Run("(c)") == "1");
+    interpreter.Run("(define c 1)");
+    REQUIRE(interpreter.CollectGarbage().freed == 2);
+    interpreter.Run("(define counter 1)");
+    interpreter.CollectGarbage();
+    REQUIRE(CountNodes() == before);
+}
@@ -32,6 +32,8 @@ TEST_CASE_METHOD(SchemeTest, "PairPredicate") {
     ExpectEq("(pair? '(1 . 2))", "#t");
     ExpectEq("(pair? '(1 2))", "#t");
     ExpectEq("(pair? '())", "#f");
+    ExpectEq("(pair? '(1 2 3))", "#t");
+    ExpectEq("(pair? 1)", "#f");
 }
 
 TEST_CASE_METHOD(SchemeTest, "NullPredicate") {
@@ -76,4 +78,88 @@ TEST_CASE_METHOD(SchemeTest, "ListOperations") {
     ExpectRuntimeError("(list-ref '(1 2 3) 3)");
     ExpectRuntimeError("(list-ref '(1 2 3) 10)");
     ExpectRuntimeError("(list-tail '(1 2 3) 10)");
+    ExpectRuntimeError("(list-ref '(1 2 3) -1)");
+}
+
+TEST_CASE_METHOD(SchemeTest, "ListTailSharesCells") {
+    ExpectNoError("(define x '(1 2 3 4))");
+    ExpectNoError("(define y (list-tail x 2))");
+    ExpectNoError("(set-car! y 5)");
+    ExpectEq("x", "(1 2 5 4)");
+    ExpectEq("(list-ref x 2)", "5");
+    ExpectEq("(list-tail '(1 2 . 3) 2)", "3");
+    ExpectRuntimeError("(list-ref '(1 2 . 3) 2)");
+}
+
+TEST_CASE_METHOD(SchemeTest, "CircularListIsNotList") {
+    ExpectNoError("(define x '(1 2 3))");
+    ExpectNoError("(set-cdr! (list-tail x 2) x)");
+    ExpectEq("(list? x)", "#f");
+    ExpectEq("(pair? x)", "#t");
+    ExpectEq("(list-ref x 4)", "2");
+    ExpectNoError("(set-cdr! (list-tail x 2) '())");
+}
+
+TEST_CASE("Cells are reused from the pool") {
+    auto first = CellPool::GetStats();
+    {
+        auto list = MakeCell(MakeNumber(1), MakeCell(MakeNumber(2), nullptr));
+        REQUIRE(CellPool::GetStats().live == first.live + 2);
+    }
+    auto second = CellPool::GetStats();
+    REQUIRE(second.live == first.live);
+    REQUIRE(second.allocations == first.allocations + 2);
+    REQUIRE(second.frees == first.frees + 2);
+
+    // the freed blocks come back first, so the pool does not grow
+    Interpreter interpreter;
+    for (int i = 0; i < 1000; ++i) {
+        interpreter.Run("(cons 1 (cons 2 3))");
+    }
+    REQUIRE(CellPool::GetStats().reserved == second.reserved);
+}
+
+TEST_CASE("Dropping long and deep lists") {
+    const int n = 1000000;
+    std::shared_ptr<Object> list;
+    for (int i = 0; i < n; ++i) {
+        list = MakeCell(MakeNumber(i % 100), list);
+    }
+    auto shared_tail = list;
+    for (int i = 0; i < n; ++i) {
+        list = MakeCell(MakeNumber(i % 100), list);
+    }
+    auto live = CellPool::GetStats().live;
+    list = nullptr;
+    REQUIRE(CellPool::GetStats().live == live - n);
+    REQUIRE(As<Number>(As<Cell>(shared_tail)->GetFirst())->GetValue() == 99);
+    shared_tail = nullptr;
+
+    std::shared_ptr<Object> deep;
+    for (int i = 0; i < n; ++i) {
+        deep = MakeCell(deep, i % 2 ? MakeCell(MakeNumber(i % 100), nullptr) : nullptr);
+    }
+    deep = nullptr;
+    REQUIRE(CellPool::GetStats().live == live - 2 * n);
+}
+
+TEST_CASE_METHOD(SchemeTest, "Printing long and deep lists") {
+    const int n = 300000;
+    std::string flat;
+    for (int i = 0; i < n; ++i) {
+        flat += std::to_string(i % 100) + " ";
+    }
+    flat += "end";
+    ExpectEq("'(" + flat + ")", "(" + flat + ")");
+    ExpectEq("'(" + flat + " . 1)", "(" + flat + " . 1)");
+
+    // nested lists print without their own parentheses
+    std::string deep;
+    std::string printed;
+    for (int i = 0; i < n; ++i) {
+        deep += "(" + std::to_string(i % 100) + " ";
+        printed += std::to_string(i % 100) + " ";
+    }
+    ExpectEq("'" + deep + "end" + std::string(n, ')'), "(" + printed + "end)");
+    ExpectEq("'" + std::string(n, '(') + "end" + std::string(n, ')'), "(end)");
 }
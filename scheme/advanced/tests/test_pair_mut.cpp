@@ -47,3 +47,29 @@ TEST_CASE_METHOD(SchemeTest, "SelfReferenceCdr") {
     ExpectNoError("(set-cdr! (cdr (cdr y)) 3)");
     ExpectEq("(cdr y)", "3");
 }
+
+TEST_CASE("Garbage cycles are collected") {
+    Interpreter interpreter;
+    interpreter.CollectGarbage();
+    size_t before = CountNodes();
+
+    interpreter.Run("(define x '(1 2 3))");
+    interpreter.Run("(set-cdr! (cdr (cdr x)) x)");
+    interpreter.Run("(define y (cons 1 2))");
+    interpreter.Run("(set-car! y y)");
+    REQUIRE(interpreter.Run("(car (cdr (cdr (cdr x))))") == "1");
+    // both lists are still referenced from the scope
+    REQUIRE(interpreter.CollectGarbage().freed == 0);
+
+    interpreter.Run("(define x 1)");
+    interpreter.Run("(define y 1)");
+    auto stats = interpreter.CollectGarbage();
+    REQUIRE(stats.freed == 4);
+    REQUIRE(CountNodes() == before);
+
+    // a cycle held by the embedding code is a root
+    auto cell = std::make_shared<Cell>(nullptr, nullptr);
+    cell->SetSecond(cell);
+    REQUIRE(interpreter.CollectGarbage().freed == 0);
+    cell->SetSecond(nullptr);
+}
@@ -1,9 +1,13 @@
 #include <catch.hpp>
 
+#include <filesystem>
+#include <fstream>
 #include <sstream>
 
 #include <error.h>
 #include <parser.h>
+#include <incremental_tokenizer.h>
+#include <program_image.h>
 
 auto ReadFull(const std::string& str) {
     std::stringstream ss{str};
@@ -154,3 +158,131 @@ TEST_CASE("Invalid") {
     REQUIRE_THROWS_AS(ReadFull("(1 . )"), SyntaxError);
     REQUIRE_THROWS_AS(ReadFull("(1 . 2 3)"), SyntaxError);
 }
+
+TEST_CASE("Read from a token array") {
+    std::string input = "(define x '(1 . 2)) (car x)";
+    auto tokens = TokenizeAll(input);
+    Tokenizer tokenizer{tokens};
+
+    auto define = Read(&tokenizer);
+    REQUIRE(Is<Cell>(define));
+    REQUIRE(As<Symbol>(As<Cell>(define)->GetFirst())->GetName() == "define");
+
+    auto car = Read(&tokenizer);
+    REQUIRE(Is<Cell>(car));
+    REQUIRE(As<Symbol>(As<Cell>(car)->GetFirst())->GetName() == "car");
+    REQUIRE(tokenizer.IsEnd());
+}
+
+TEST_CASE("Read tokens fed in chunks") {
+    IncrementalTokenizer incremental;
+    incremental.Feed("(1 (fo");
+    incremental.Feed("o . 2) '");
+    incremental.Feed("bar)");
+    auto tokens = incremental.TakeTokens();
+
+    Tokenizer tokenizer{tokens};
+    auto list = Read(&tokenizer);
+    REQUIRE(tokenizer.IsEnd());
+    REQUIRE(As<Number>(As<Cell>(list)->GetFirst())->GetValue() == 1);
+    auto pair = As<Cell>(As<Cell>(As<Cell>(list)->GetSecond())->GetFirst());
+    REQUIRE(As<Symbol>(pair->GetFirst())->GetName() == "foo");
+    REQUIRE(As<Number>(pair->GetSecond())->GetValue() == 2);
+}
+
+TEST_CASE("Long and deep lists") {
+    const int n = 20000;
+    std::string flat = "(";
+    for (int i = 0; i < n; ++i) {
+        flat += std::to_string(i) + " ";
+    }
+    flat += ". end)";
+    auto list = ReadFull(flat);
+    for (int i = 0; i < n; ++i) {
+        REQUIRE(As<Number>(As<Cell>(list)->GetFirst())->GetValue() == i);
+        list = As<Cell>(list)->GetSecond();
+    }
+    REQUIRE(As<Symbol>(list)->GetName() == "end");
+
+    std::string deep = std::string(n, '(') + "'x" + std::string(n, ')');
+    auto nested = ReadFull(deep);
+    for (int i = 0; i < n; ++i) {
+        REQUIRE(Is<Cell>(nested));
+        REQUIRE(!As<Cell>(nested)->GetSecond());
+        nested = As<Cell>(nested)->GetFirst();
+    }
+    REQUIRE(As<Symbol>(As<Cell>(nested)->GetFirst())->GetName() == "quote");
+
+    REQUIRE_THROWS_AS(ReadFull(std::string(n, '(')), SyntaxError);
+    REQUIRE_THROWS_AS(ReadFull(std::string(n, '\'')), SyntaxError);
+}
+
+TEST_CASE("Dots") {
+    auto pair = ReadFull("(1 . .)");
+    REQUIRE(As<Symbol>(As<Cell>(pair)->GetSecond())->GetName() == ".");
+    REQUIRE(As<Symbol>(ReadFull("."))->GetName() == ".");
+
+    REQUIRE_THROWS_AS(ReadFull("(1 . 2 .)"), SyntaxError);
+    REQUIRE_THROWS_AS(ReadFull("(1 . . 2)"), SyntaxError);
+    REQUIRE_THROWS_AS(ReadFull("(')"), SyntaxError);
+}
+
+TEST_CASE("Read into an arena") {
+    std::shared_ptr<Object> list;
+    {
+        Arena* raw = new Arena(0);
+        ArenaAllocator<Object> arena(raw);
+        Tokenizer tokenizer{std::string_view("(1 'foo . bar)")};
+        list = Read(&tokenizer, arena);
+        REQUIRE(raw->BytesUsed() > 0);
+    }
+    // the nodes keep the arena alive after the allocator that created it is gone
+    REQUIRE(As<Number>(As<Cell>(list)->GetFirst())->GetValue() == 1);
+    auto rest = As<Cell>(As<Cell>(list)->GetSecond());
+    REQUIRE(As<Symbol>(As<Cell>(rest->GetFirst())->GetFirst())->GetName() == "quote");
+    REQUIRE(As<Symbol>(rest->GetSecond())->GetName() == "bar");
+}
+
+TEST_CASE("Program images") {
+    std::string source =
+        "(define x '(1 . -2)) (car x)\n foo 42 () (a (b (c . d)) e) -18446744073709551616";
+    auto image = CompileProgram(source);
+
+    ProgramImage loaded{std::string_view(image)};
+    Tokenizer tokenizer{std::string_view(source)};
+    while (!tokenizer.IsEnd()) {
+        REQUIRE(!loaded.IsEnd());
+        auto expected = Read(&tokenizer);
+        auto form = Read(&loaded);
+        if (expected) {
+            REQUIRE(form->GetType() == expected->GetType());
+            REQUIRE(form->ToString() == expected->ToString());
+        }
+        else {
+            REQUIRE(!form);
+        }
+    }
+    REQUIRE(loaded.IsEnd());
+
+    auto path = std::filesystem::temp_directory_path() / "scheme_test_program.img";
+    {
+        std::ofstream out(path, std::ios::binary);
+        out << image;
+    }
+    ProgramImage mapped{path.string()};
+    auto define = Read(&mapped, ArenaAllocator<Object>(new Arena(0)));
+    REQUIRE(As<Symbol>(As<Cell>(define)->GetFirst())->GetName() == "define");
+    std::filesystem::remove(path);
+
+    // the symbol table keeps one copy of every name
+    REQUIRE(CompileProgram("(x x x x x x)").size() < CompileProgram("(x y z u v w)").size());
+
+    REQUIRE_THROWS_AS(ProgramImage{std::string_view("(car x)")}, RuntimeError);
+    std::string truncated = image.substr(0, image.size() - 3);
+    ProgramImage broken{std::string_view(truncated)};
+    REQUIRE_THROWS_AS([&] {
+        while (!broken.IsEnd()) {
+            Read(&broken);
+        }
+    }(), RuntimeError);
+}
@@ -2,8 +2,14 @@
 
 #include <error.h>
 #include <tokenizer.h>
+#include <mapped_file.h>
+#include <incremental_tokenizer.h>
 
+#include <filesystem>
+#include <fstream>
+#include <random>
 #include <sstream>
+#include <type_traits>
 
 TEST_CASE("Tokenizer works on simple case") {
     std::stringstream ss{"4+)'."};
@@ -153,3 +159,196 @@ TEST_CASE("Empty string handled correctly") {
 
     REQUIRE(tokenizer.IsEnd());
 }
+
+TEST_CASE("Buffer tokenizer matches stream tokenizer") {
+    std::string input = "(define (f x)\n  (+ x -12 +7 'zog-zog? . #t))";
+    std::stringstream ss{input};
+    Tokenizer stream_tokenizer{&ss};
+    Tokenizer buffer_tokenizer{std::string_view(input)};
+
+    while (!stream_tokenizer.IsEnd()) {
+        REQUIRE(!buffer_tokenizer.IsEnd());
+        REQUIRE(stream_tokenizer.GetToken() == buffer_tokenizer.GetToken());
+        stream_tokenizer.Next();
+        buffer_tokenizer.Next();
+    }
+    REQUIRE(buffer_tokenizer.IsEnd());
+}
+
+TEST_CASE("Symbols are interned") {
+    std::string input = "(foo bar)";
+    Tokenizer tokenizer{std::string_view(input)};
+
+    tokenizer.Next();
+    auto foo = std::get<SymbolToken>(tokenizer.GetToken());
+    REQUIRE(foo.GetName() == "foo");
+    REQUIRE(foo.id == Intern("foo"));
+    REQUIRE(foo.id != Intern("bar"));
+    REQUIRE(GetSymbolName(kQuoteSymbol) == "quote");
+
+    tokenizer.Next();
+    tokenizer.Next();
+    REQUIRE(tokenizer.GetToken() == Token{BracketToken::CLOSE});
+    tokenizer.Next();
+    REQUIRE(tokenizer.IsEnd());
+}
+
+TEST_CASE("Buffer tokenizer errors") {
+    REQUIRE_THROWS_AS(Tokenizer{std::string_view("ab,c")}, SyntaxError);
+    REQUIRE_THROWS_AS(Tokenizer{std::string_view("@")}, SyntaxError);
+    REQUIRE(Tokenizer{std::string_view("")}.IsEnd());
+    REQUIRE(Tokenizer{std::string_view(" \n ")}.IsEnd());
+}
+
+TEST_CASE("Tokenizer over a mapped file") {
+    auto path = std::filesystem::temp_directory_path() / "scheme_tokenizer_test.scm";
+    {
+        std::ofstream out{path};
+        out << "(1 . two)";
+    }
+    {
+        MappedFile file{path.string()};
+        Tokenizer tokenizer{file.View()};
+        REQUIRE(tokenizer.GetToken() == Token{BracketToken::OPEN});
+        tokenizer.Next();
+        REQUIRE(tokenizer.GetToken() == Token{ConstantToken{1}});
+        tokenizer.Next();
+        REQUIRE(tokenizer.GetToken() == Token{DotToken{}});
+        tokenizer.Next();
+        REQUIRE(tokenizer.GetToken() == Token{SymbolToken{"two"}});
+        tokenizer.Next();
+        REQUIRE(tokenizer.GetToken() == Token{BracketToken::CLOSE});
+        tokenizer.Next();
+        REQUIRE(tokenizer.IsEnd());
+    }
+    std::filesystem::remove(path);
+
+    REQUIRE_THROWS_AS(MappedFile{path.string()}, RuntimeError);
+}
+
+TEST_CASE("Number limits") {
+    std::stringstream ss{"2147483648 9223372036854775807 -9223372036854775808 +0012"};
+    Tokenizer tokenizer{&ss};
+
+    REQUIRE(tokenizer.GetToken() == Token{ConstantToken{2147483648}});
+    tokenizer.Next();
+    REQUIRE(tokenizer.GetToken() == Token{ConstantToken{INT64_MAX}});
+    tokenizer.Next();
+    REQUIRE(tokenizer.GetToken() == Token{ConstantToken{INT64_MIN}});
+    tokenizer.Next();
+    REQUIRE(tokenizer.GetToken() == Token{ConstantToken{12}});
+
+    // longer literals are bignums
+    std::stringstream big{"9223372036854775808 -9223372036854775809)"};
+    Tokenizer big_tokenizer{&big};
+    REQUIRE(big_tokenizer.GetToken() == Token{BigNumberToken{"9223372036854775808"}});
+    big_tokenizer.Next();
+    REQUIRE(big_tokenizer.GetToken() == Token{BigNumberToken{"-9223372036854775809"}});
+    big_tokenizer.Next();
+    REQUIRE(big_tokenizer.GetToken() == Token{BracketToken::CLOSE});
+}
+
+TEST_CASE("TokenizeAll") {
+    std::string input = "(+ 1 'x)";
+    auto tokens = TokenizeAll(input);
+    std::vector<Token> expected{BracketToken::OPEN, SymbolToken{"+"}, ConstantToken{1},
+                                QuoteToken{},       SymbolToken{"x"}, BracketToken::CLOSE};
+    REQUIRE(tokens == expected);
+
+    Tokenizer tokenizer{tokens};
+    for (const auto& token : expected) {
+        REQUIRE(!tokenizer.IsEnd());
+        REQUIRE(tokenizer.GetToken() == token);
+        tokenizer.Next();
+    }
+    REQUIRE(tokenizer.IsEnd());
+    // the tokens must outlive the tokenizer
+    STATIC_REQUIRE(!std::is_constructible_v<Tokenizer, std::vector<Token>&&>);
+
+    REQUIRE(TokenizeAll("  ").empty());
+    REQUIRE_THROWS_AS(TokenizeAll("(a,b)"), SyntaxError);
+}
+
+TEST_CASE("Incremental tokenizer keeps state across chunks") {
+    IncrementalTokenizer tokenizer;
+    tokenizer.Feed("(def");
+    REQUIRE(tokenizer.GetToken() == Token{BracketToken::OPEN});
+    tokenizer.Next();
+    REQUIRE(tokenizer.IsEnd());
+
+    tokenizer.Feed("ine x -1");
+    REQUIRE(tokenizer.GetToken() == Token{SymbolToken{"define"}});
+    tokenizer.Next();
+    REQUIRE(tokenizer.GetToken() == Token{SymbolToken{"x"}});
+    tokenizer.Next();
+    REQUIRE(tokenizer.IsEnd());
+
+    tokenizer.Feed("23)");
+    REQUIRE(tokenizer.GetToken() == Token{ConstantToken{-123}});
+    tokenizer.Next();
+    REQUIRE(tokenizer.GetToken() == Token{BracketToken::CLOSE});
+    tokenizer.Next();
+    REQUIRE(tokenizer.IsEnd());
+
+    tokenizer.Feed("foo");
+    REQUIRE(tokenizer.IsEnd());
+    tokenizer.Finish();
+    REQUIRE(tokenizer.GetToken() == Token{SymbolToken{"foo"}});
+}
+
+TEST_CASE("Incremental tokenizer matches TokenizeAll on any split") {
+    std::string input = "(define (f x)\n  (+ x -12 +7 '(zog-zog? . #t) - + 1543 Am1good?))";
+    auto expected = TokenizeAll(input);
+
+    std::mt19937 gen(42);
+    for (int i = 0; i < 100; ++i) {
+        IncrementalTokenizer tokenizer;
+        std::vector<Token> tokens;
+        size_t pos = 0;
+        while (pos < input.size()) {
+            size_t len = std::uniform_int_distribution<size_t>(1, 8)(gen);
+            tokenizer.Feed(std::string_view(input).substr(pos, len));
+            pos += len;
+            while (!tokenizer.IsEnd()) {
+                tokens.push_back(tokenizer.GetToken());
+                tokenizer.Next();
+            }
+        }
+        tokenizer.Finish();
+        auto rest = tokenizer.TakeTokens();
+        tokens.insert(tokens.end(), rest.begin(), rest.end());
+        REQUIRE(tokens == expected);
+    }
+}
+
+TEST_CASE("Incremental tokenizer bignums") {
+    IncrementalTokenizer tokenizer;
+    tokenizer.Feed("(-92233720");
+    tokenizer.Feed("368547758");
+    tokenizer.Feed("09123 1");
+    tokenizer.Feed("8446744073709551616)");
+    std::vector<Token> expected{BracketToken::OPEN,
+                                BigNumberToken{"-9223372036854775809123"},
+                                BigNumberToken{"18446744073709551616"},
+                                BracketToken::CLOSE};
+    REQUIRE(tokenizer.TakeTokens() == expected);
+
+    // the digits are not names
+    size_t symbols = SymbolCount();
+    tokenizer.Feed("123456789012345678901234567890 ");
+    REQUIRE(TokenizeAll("-123456789012345678901234567891").size() == 1);
+    REQUIRE(SymbolCount() == symbols);
+}
+
+TEST_CASE("Incremental tokenizer errors") {
+    IncrementalTokenizer tokenizer;
+    tokenizer.Feed("(a");
+    REQUIRE_THROWS_AS(tokenizer.Feed(",b)"), SyntaxError);
+    REQUIRE_THROWS_AS(tokenizer.Feed("@"), SyntaxError);
+
+    tokenizer.Feed(" 1 ");
+    tokenizer.TakeTokens();
+    tokenizer.Feed("2");
+    tokenizer.Finish();
+    REQUIRE(tokenizer.TakeTokens() == std::vector<Token>{ConstantToken{2}});
+}
@@ -0,0 +1,81 @@
+#include "scheme_test.h"
+
+TEST_CASE_METHOD(SchemeTest, "VectorsAreSelfEvaluating") {
+    ExpectEq("(vector 1 2 3)", "#(1 2 3)");
+    ExpectEq("(vector)", "#()");
+    ExpectEq("(vector 1 '(2 3) '() 'a)", "#(1 (2 3) () a)");
+    ExpectEq("(make-vector 3)", "#(0 0 0)");
+    ExpectEq("(make-vector 2 'x)", "#(x x)");
+    ExpectEq("(make-vector 0)", "#()");
+
+    ExpectEq("(vector? (vector 1))", "#t");
+    ExpectEq("(vector? '(1))", "#f");
+}
+
+TEST_CASE_METHOD(SchemeTest, "VectorAccess") {
+    ExpectNoError("(define v (make-vector 3 0))");
+    ExpectEq("(vector-length v)", "3");
+    ExpectNoError("(vector-set! v 1 (+ 2 3))");
+    ExpectEq("(vector-ref v 1)", "5");
+    ExpectEq("(vector-ref v 0)", "0");
+    ExpectEq("v", "#(0 5 0)");
+
+    ExpectRuntimeError("(vector-ref v 3)");
+    ExpectRuntimeError("(vector-ref v -1)");
+    ExpectRuntimeError("(vector-ref v 'a)");
+    ExpectRuntimeError("(vector-set! v 3 1)");
+    ExpectRuntimeError("(vector-ref '(1 2) 0)");
+    ExpectRuntimeError("(vector-length 1)");
+    ExpectRuntimeError("(make-vector -1)");
+    ExpectRuntimeError("(make-vector 100000000000000)");
+    ExpectRuntimeError("(make-vector 4611686018427387904)");
+    ExpectRuntimeError("(make-vector (* 4294967296 4294967296))");
+}
+
+TEST_CASE_METHOD(SchemeTest, "VectorConversions") {
+    ExpectEq("(vector->list (vector 1 2 3))", "(1 2 3)");
+    ExpectEq("(vector->list (vector))", "()");
+    ExpectEq("(list->vector '(1 2 3))", "#(1 2 3)");
+    ExpectEq("(list->vector '())", "#()");
+    ExpectRuntimeError("(list->vector '(1 . 2))");
+    ExpectRuntimeError("(list->vector 1)");
+
+    ExpectNoError("(define v (list->vector '(1 2)))");
+    ExpectNoError("(vector-set! v 0 v)");
+    ExpectEq("(vector-ref (vector-ref v 0) 1)", "2");
+}
+
+TEST_CASE("Vector cycles are collected") {
+    Interpreter interpreter;
+    interpreter.CollectGarbage();
+    size_t before = CountNodes();
+    interpreter.Run("(define v (vector 1 2))");
+    interpreter.Run("(vector-set! v 1 v)");
+    interpreter.Run("(define v 1)");
+    REQUIRE(interpreter.CollectGarbage().freed == 1);
+    REQUIRE(CountNodes() == before);
+}
+
+TEST_CASE_METHOD(SchemeTest, "PrintingNestedVectors") {
+    ExpectEq("(vector (vector 1 '(2 3)) '() (vector))", "#(#(1 (2 3)) () #())");
+    ExpectNoError("(define v (make-vector 2 0))");
+    ExpectEq("(list v v)", "(#(0 0) #(0 0))");
+    ExpectNoError("(define w (vector v v))");
+    ExpectEq("w", "#(#(0 0) #(0 0))");
+
+    ExpectNoError("(vector-set! v 0 v)");
+    ExpectRuntimeError("v");
+    ExpectRuntimeError("w");
+    ExpectNoError("(vector-set! v 0 (list w))");
+    ExpectRuntimeError("v");
+    ExpectNoError("(vector-set! v 0 1)");
+    ExpectEq("w", "#(#(1 0) #(1 0))");
+
+    const int n = 100000;
+    ExpectNoError("(define (nest n v) (if (= n 0) v (nest (- n 1) (vector v))))");
+    std::string printed;
+    for (int i = 0; i < n; ++i) {
+        printed += "#(";
+    }
+    ExpectEq("(nest " + std::to_string(n) + " 0)", printed + "0" + std::string(n, ')'));
+}
@@ -1,25 +1,172 @@
 #include <tokenizer.h>
 #include <error.h>
-#include <iostream>
+#include <char_class.h>
 
-const char kSpace = ' ';
-const char kEndLine = '\n';
 const char kLeftBracket = '(';
 const char kRightBracket = ')';
 const char kQuote = '\'';
 const char kDot = '.';
 const char kPlus = '+';
 const char kMinus = '-';
-const std::string kStartPossibleChar = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ<=>*/#";
-const std::string kOtherPossibleChar =
-"abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ<=>*/#0123456789?!-";
-const std::string kDigits = "0123456789";
 
-SymbolToken::SymbolToken(const std::string& val) : name(val) {
+namespace {
+
+// Character sources for ReadToken. Skip() drops a character, Take() appends it to the
+// current lexeme started by StartLexeme().
+
+class StreamSource {
+public:
+    StreamSource(std::istream* in, std::string* scratch) : in_(in), scratch_(scratch) {
+    }
+
+    int Peek() {
+        return in_->peek();
+    }
+
+    void Skip() {
+        in_->get();
+    }
+
+    void StartLexeme() {
+        scratch_->clear();
+    }
+
+    void Take() {
+        scratch_->push_back(in_->get());
+    }
+
+    std::string_view Lexeme() const {
+        return *scratch_;
+    }
+
+private:
+    std::istream* in_;
+    std::string* scratch_;
+};
+
+class BufferSource {
+public:
+    BufferSource(std::string_view buffer, size_t* pos) : buffer_(buffer), pos_(pos), start_(0) {
+    }
+
+    int Peek() {
+        if (*pos_ == buffer_.size()) {
+            return EOF;
+        }
+        return static_cast<unsigned char>(buffer_[*pos_]);
+    }
+
+    void Skip() {
+        ++*pos_;
+    }
+
+    void StartLexeme() {
+        start_ = *pos_;
+    }
+
+    void Take() {
+        ++*pos_;
+    }
+
+    std::string_view Lexeme() const {
+        return buffer_.substr(start_, *pos_ - start_);
+    }
+
+private:
+    std::string_view buffer_;
+    size_t* pos_;
+    size_t start_;
+};
+
+// The digits of a literal too long for int64_t, after those that make up the prefix.
+template <class Source>
+Token ReadBigNumber(Source* src, int64_t prefix) {
+    std::string digits = std::to_string(prefix);
+    while (HasCharClass(src->Peek(), kDigitClass)) {
+        digits.push_back(static_cast<char>(src->Peek()));
+        src->Skip();
+    }
+    return BigNumberToken(digits);
+}
+
+template <class Source>
+Token ReadNumber(Source* src, bool negative) {
+    int64_t value = 0;
+    while (HasCharClass(src->Peek(), kDigitClass)) {
+        if (!AppendDigit(&value, src->Peek() - '0', negative)) {
+            return ReadBigNumber(src, value);
+        }
+        src->Skip();
+    }
+    return ConstantToken(value);
+}
+
+template <class Source>
+std::optional<Token> ReadToken(Source* src) {
+    while (HasCharClass(src->Peek(), kSpaceClass)) {
+        src->Skip();
+    }
+    int curr = src->Peek();
+    if (curr == EOF) {
+        return std::nullopt;
+    }
+    if (curr == kLeftBracket) {
+        src->Skip();
+        return Token(BracketToken::OPEN);
+    }
+    else if (curr == kRightBracket) {
+        src->Skip();
+        return Token(BracketToken::CLOSE);
+    }
+    else if (curr == kQuote) {
+        src->Skip();
+        return Token(QuoteToken());
+    }
+    else if (curr == kDot) {
+        src->Skip();
+        return Token(DotToken());
+    }
+    else if (HasCharClass(curr, kDigitClass)) {
+        return ReadNumber(src, false);
+    }
+    else if (curr == kPlus || curr == kMinus) {
+        src->StartLexeme();
+        src->Take();
+        if (HasCharClass(src->Peek(), kDigitClass)) {
+            return ReadNumber(src, curr == kMinus);
+        }
+        return Token(SymbolToken(src->Lexeme()));
+    }
+    else if (HasCharClass(curr, kSymbolStartClass)) {
+        src->StartLexeme();
+        while (HasCharClass(curr, kSymbolClass)) {
+            src->Take();
+            curr = src->Peek();
+        }
+        if (curr != EOF && !HasCharClass(curr, kSpaceClass) && curr != kRightBracket) {
+            throw SyntaxError("Unresolved mid character");
+        }
+        return Token(SymbolToken(src->Lexeme()));
+    }
+    else {
+        throw SyntaxError("Unresolved start character");
+    }
+}
+
+}  // namespace
+
+SymbolToken::SymbolToken(std::string_view name) : id(Intern(name)) {
+}
+
+SymbolToken::SymbolToken(SymbolId id) : id(id) {
+}
+
+const std::string& SymbolToken::GetName() const {
+    return GetSymbolName(id);
 }
 
 bool SymbolToken::operator==(const SymbolToken& other) const {
-    return name == other.name;
+    return id == other.id;
 }
 
 bool QuoteToken::operator==(const QuoteToken&) const {
@@ -30,19 +177,41 @@ bool DotToken::operator==(const DotToken&) const {
     return true;
 }
 
-ConstantToken::ConstantToken(int val) : value(val) {
+ConstantToken::ConstantToken(int64_t val) : value(val) {
 }
 
 bool ConstantToken::operator==(const ConstantToken& other) const {
     return value == other.value;
 }
 
-Tokenizer::Tokenizer(std::istream* in) : in_(in), token_(nullptr) {
+BigNumberToken::BigNumberToken(std::string_view digits)
+    : value(std::make_shared<const BigInt>(BigInt::FromString(digits))) {
+}
+
+bool BigNumberToken::operator==(const BigNumberToken& other) const {
+    return *value == *other.value;
+}
+
+Tokenizer::Tokenizer(std::istream* in)
+    : in_(in), pos_(0), replay_(nullptr), replay_end_(nullptr) {
+    this->Next();
+}
+
+Tokenizer::Tokenizer(std::string_view buffer)
+    : in_(nullptr), buffer_(buffer), pos_(0), replay_(nullptr), replay_end_(nullptr) {
+    this->Next();
+}
+
+Tokenizer::Tokenizer(const std::vector<Token>& tokens)
+    : in_(nullptr), pos_(0), replay_(tokens.data()), replay_end_(tokens.data() + tokens.size()) {
     this->Next();
 }
 
 bool Tokenizer::IsEnd() {
-    if (in_->peek() == EOF && token_ == nullptr) {
+    if (in_ == nullptr) {
+        return !token_;
+    }
+    if (in_->peek() == EOF && !token_) {
         return true;
     }
     else {
@@ -51,87 +220,36 @@ bool Tokenizer::IsEnd() {
 }
 
 void Tokenizer::Next() {
-    while (in_->peek() == kSpace || in_->peek() == kEndLine) {
-        in_->get();
-    }
-    if (in_->peek() == EOF) {
-        token_.reset(nullptr);
-        return;
-    }
-    char curr = in_->peek();
-    if (curr == kLeftBracket) {
-        in_->get();
-        token_.reset(new Token(BracketToken::OPEN));
-    }
-    else if (curr == kRightBracket) {
-        in_->get();
-        token_.reset(new Token(BracketToken::CLOSE));
-    }
-    else if (curr == kQuote) {
-        in_->get();
-        token_.reset(new Token(QuoteToken()));
-    }
-    else if (curr == kDot) {
-        in_->get();
-        token_.reset(new Token(DotToken()));
-    }
-    else if (kDigits.find(curr) != std::string::npos) {
-        std::string temp;
-        while (kDigits.find(curr) != std::string::npos) {
-            temp.push_back(in_->get());
-            curr = in_->peek();
-        }
-        token_.reset(new Token(ConstantToken(std::stoi(temp))));
-    }
-    else if (curr == kPlus) {
-        std::string temp;
-        temp.push_back(in_->get());
-        curr = in_->peek();
-        if (kDigits.find(curr) != std::string::npos) {
-            while (kDigits.find(curr) != std::string::npos) {
-                temp.push_back(in_->get());
-                curr = in_->peek();
-            }
-            token_.reset(new Token(ConstantToken(std::stoi(temp))));
-        }
-        else {
-            token_.reset(new Token(SymbolToken(temp)));
-        }
-    }
-    else if (curr == kMinus) {
-        std::string temp;
-        temp.push_back(in_->get());
-        curr = in_->peek();
-        if (kDigits.find(curr) != std::string::npos) {
-            while (kDigits.find(curr) != std::string::npos) {
-                temp.push_back(in_->get());
-                curr = in_->peek();
-            }
-            token_.reset(new Token(ConstantToken(std::stoi(temp))));
+    if (replay_ != nullptr) {
+        if (replay_ == replay_end_) {
+            token_.reset();
         }
         else {
-            token_.reset(new Token(SymbolToken(temp)));
+            token_ = *replay_++;
         }
     }
-    else if (kStartPossibleChar.find(curr) != std::string::npos) {
-        std::string temp;
-        while (kOtherPossibleChar.find(curr) != std::string::npos) {
-            temp.push_back(in_->get());
-            curr = in_->peek();
-        }
-        if (curr != EOF && curr != kSpace && curr != kEndLine && curr != kRightBracket) {
-            std::cout << curr;
-            throw SyntaxError("Unresolved mid character");
-        }
-        else {
-            token_.reset(new Token(SymbolToken(temp)));
-        }
+    else if (in_ == nullptr) {
+        BufferSource src(buffer_, &pos_);
+        token_ = ReadToken(&src);
     }
     else {
-        throw SyntaxError("Unresolved start character");
+        StreamSource src(in_, &scratch_);
+        token_ = ReadToken(&src);
     }
 }
 
-Token Tokenizer::GetToken() {
-    return *(token_.get());
-}
\ No newline at end of file
+const Token& Tokenizer::GetToken() const {
+    return *token_;
+}
+
+std::vector<Token> TokenizeAll(std::string_view buffer) {
+    std::vector<Token> tokens;
+    // typical sources have a token every few bytes, this avoids most regrowth
+    tokens.reserve(buffer.size() / 4);
+    size_t pos = 0;
+    BufferSource src(buffer, &pos);
+    while (auto token = ReadToken(&src)) {
+        tokens.push_back(*token);
+    }
+    return tokens;
+}
@@ -1,15 +1,26 @@
 #pragma once
 
+#include <cstdint>
 #include <variant>
 #include <optional>
 #include <istream>
 #include <memory>
 #include <string>
+#include <string_view>
+#include <vector>
+
+#include <bigint.h>
+#include <symbol_table.h>
 
 struct SymbolToken {
-    std::string name;
+    SymbolId id;
+
+    // Interns the name.
+    SymbolToken(std::string_view name);
+
+    explicit SymbolToken(SymbolId id);
 
-    SymbolToken(const std::string& val);
+    const std::string& GetName() const;
 
     bool operator==(const SymbolToken& other) const;
 };
@@ -25,26 +36,56 @@ struct DotToken {
 enum class BracketToken { OPEN, CLOSE };
 
 struct ConstantToken {
-    int value;
+    int64_t value;
 
-    ConstantToken(int val);
+    ConstantToken(int64_t val);
 
     bool operator==(const ConstantToken& other) const;
 };
 
-using Token = std::variant<ConstantToken, BracketToken, SymbolToken, QuoteToken, DotToken>;
+// An integer literal that does not fit into int64_t. The value is shared, so that copying
+// tokens stays cheap.
+struct BigNumberToken {
+    std::shared_ptr<const BigInt> value;
+
+    // The digits after an optional minus.
+    explicit BigNumberToken(std::string_view digits);
+
+    bool operator==(const BigNumberToken& other) const;
+};
+
+using Token = std::variant<ConstantToken, BracketToken, SymbolToken, QuoteToken, DotToken,
+                           BigNumberToken>;
 
 class Tokenizer {
 public:
+    // Reads characters lazily from the stream, so it may be fed while tokenizing.
     Tokenizer(std::istream* in);
 
+    // Works directly over a contiguous buffer, which must outlive the tokenizer.
+    Tokenizer(std::string_view buffer);
+
+    // Replays tokens produced by TokenizeAll, the vector must outlive the tokenizer.
+    Tokenizer(const std::vector<Token>& tokens);
+
+    // A temporary vector would be gone before the tokens are read.
+    Tokenizer(std::vector<Token>&& tokens) = delete;
+
     bool IsEnd();
 
     void Next();
 
-    Token GetToken();
+    const Token& GetToken() const;
 
 private:
     std::istream* in_;
-    std::unique_ptr<Token> token_;
-};
\ No newline at end of file
+    std::string_view buffer_;
+    size_t pos_;
+    std::string scratch_;
+    const Token* replay_;
+    const Token* replay_end_;
+    std::optional<Token> token_;
+};
+
+// Tokenizes the whole buffer at once.
+std::vector<Token> TokenizeAll(std::string_view buffer);
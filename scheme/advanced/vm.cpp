@@ -0,0 +1,368 @@
+#include <vm.h>
+#include <cell_pool.h>
+#include <error.h>
+
+// GCC and Clang jump straight from one instruction to the next through a table of label
+// addresses, which predicts better than the single indirect jump of a switch.
+#if defined(__GNUC__)
+#define SCHEME_COMPUTED_GOTO 1
+#endif
+
+namespace {
+
+bool IsFalse(const std::shared_ptr<Object>& obj) {
+    return Is<Symbol>(obj) && static_cast<Symbol*>(obj.get())->GetId() == kFalseSymbol;
+}
+
+// The state of a call between closures that waits for its callee to return.
+struct SuspendedCall {
+    // keeps the code alive, the closure may be unreachable otherwise
+    std::shared_ptr<Object> closure;
+    const Chunk* chunk;
+    const Instruction* ip;
+    std::shared_ptr<Frame> frame;
+};
+
+// The slot of an internal definition. Throws NameError if it is not assigned yet.
+std::shared_ptr<Object>& CheckedSlot(const Chunk& chunk, uint32_t local, Frame* frame) {
+    const Chunk::Local& variable = chunk.locals[local];
+    auto& slot = OuterFrame(frame, variable.address.depth)->slots_[variable.address.index];
+    if (slot == Unassigned()) {
+        throw NameError("No such variable: " + GetSymbolName(variable.name));
+    }
+    return slot;
+}
+
+// The stacks of the machine, kept between runs so that a short form allocates nothing.
+struct Stacks {
+    std::vector<std::shared_ptr<Object>> values;
+    std::vector<SuspendedCall> frames;
+    bool busy = false;
+};
+
+// Lends the stacks of the thread to a run and empties them when it ends, errors included. A
+// run may start while another one waits for a builtin or a closure of the tree evaluator. The
+// one waiting holds arguments that point into its value stack, so the run nested in it gets
+// stacks of its own instead.
+class StackLease {
+public:
+    explicit StackLease(Stacks* shared) : stacks_(shared->busy ? &own_ : shared) {
+        stacks_->busy = true;
+    }
+
+    ~StackLease() {
+        stacks_->values.clear();
+        stacks_->frames.clear();
+        stacks_->busy = false;
+    }
+
+    Stacks* Get() {
+        return stacks_;
+    }
+
+private:
+    Stacks own_;
+    Stacks* stacks_;
+};
+
+std::shared_ptr<Object> Run(const Chunk& top, std::shared_ptr<Frame> frame, size_t depth_limit) {
+    thread_local Stacks shared;
+    StackLease lease(&shared);
+    auto& stack = lease.Get()->values;
+    auto& frames = lease.Get()->frames;
+    std::shared_ptr<Object> closure;
+    const Chunk* chunk = &top;
+    const Instruction* ip = top.code.data();
+    std::shared_ptr<Object> value;
+    bool tail = false;
+    size_t argc = 0;
+
+#ifdef SCHEME_COMPUTED_GOTO
+    // in the order of Opcode
+    static const void* const kLabels[] = {
+        &&kConstant,    &&kLoadLocal,   &&kLoadChecked, &&kLoadGlobal,  &&kDefineLocal,
+        &&kDefineGlobal, &&kSetLocal,   &&kSetChecked,  &&kSetGlobal,   &&kPop,
+        &&kJump,        &&kJumpIfFalse, &&kBranchFalse, &&kBranchTrue,  &&kClosure,
+        &&kCall,        &&kTailCall,    &&kCallBuiltin, &&kReturn};
+#define DISPATCH() goto* kLabels[static_cast<uint8_t>(ip->op)]
+#define TARGET(op) op:
+#else
+#define DISPATCH() goto dispatch
+#define TARGET(op) case Opcode::op:
+#endif
+
+    DISPATCH();
+#ifndef SCHEME_COMPUTED_GOTO
+dispatch:
+    switch (ip->op) {
+#endif
+
+    TARGET(kConstant) {
+        stack.push_back(chunk->constants[ip->arg]);
+        ++ip;
+        DISPATCH();
+    }
+
+    TARGET(kLoadLocal) {
+        stack.push_back(OuterFrame(frame.get(), ip->depth)->slots_[ip->arg]);
+        ++ip;
+        DISPATCH();
+    }
+
+    TARGET(kLoadChecked) {
+        stack.push_back(CheckedSlot(*chunk, ip->arg, frame.get()));
+        ++ip;
+        DISPATCH();
+    }
+
+    TARGET(kLoadGlobal) {
+        stack.push_back(LookUpGlobal(ip->arg));
+        ++ip;
+        DISPATCH();
+    }
+
+    TARGET(kDefineLocal) {
+        frame->slots_[ip->arg] = std::move(stack.back());
+        stack.back() = MakeSymbol(kDefineSymbol);
+        ++ip;
+        DISPATCH();
+    }
+
+    TARGET(kDefineGlobal) {
+        DefineGlobal(ip->arg, std::move(stack.back()));
+        stack.back() = MakeSymbol(kDefineSymbol);
+        ++ip;
+        DISPATCH();
+    }
+
+    TARGET(kSetLocal) {
+        OuterFrame(frame.get(), ip->depth)->slots_[ip->arg] = std::move(stack.back());
+        stack.back() = nullptr;
+        ++ip;
+        DISPATCH();
+    }
+
+    TARGET(kSetChecked) {
+        CheckedSlot(*chunk, ip->arg, frame.get()) = std::move(stack.back());
+        stack.back() = nullptr;
+        ++ip;
+        DISPATCH();
+    }
+
+    TARGET(kSetGlobal) {
+        auto it = globals.find(ip->arg);
+        if (it == globals.end()) {
+            throw NameError("No such variable: " + GetSymbolName(ip->arg));
+        }
+        it->second = std::move(stack.back());
+        stack.back() = nullptr;
+        ++ip;
+        DISPATCH();
+    }
+
+    TARGET(kPop) {
+        stack.pop_back();
+        ++ip;
+        DISPATCH();
+    }
+
+    TARGET(kJump) {
+        ip = chunk->code.data() + ip->arg;
+        DISPATCH();
+    }
+
+    TARGET(kJumpIfFalse) {
+        const auto& condition = stack.back();
+        if (!Is<Symbol>(condition)) {
+            throw SyntaxError("Wrong condition type in if");
+        }
+        SymbolId id = static_cast<Symbol*>(condition.get())->GetId();
+        if (id != kTrueSymbol && id != kFalseSymbol) {
+            throw SyntaxError("Wrong condition type in if");
+        }
+        stack.pop_back();
+        ip = id == kFalseSymbol ? chunk->code.data() + ip->arg : ip + 1;
+        DISPATCH();
+    }
+
+    TARGET(kBranchFalse) {
+        if (IsFalse(stack.back())) {
+            ip = chunk->code.data() + ip->arg;
+        }
+        else {
+            stack.pop_back();
+            ++ip;
+        }
+        DISPATCH();
+    }
+
+    TARGET(kBranchTrue) {
+        if (!IsFalse(stack.back())) {
+            ip = chunk->code.data() + ip->arg;
+        }
+        else {
+            stack.pop_back();
+            ++ip;
+        }
+        DISPATCH();
+    }
+
+    TARGET(kClosure) {
+        stack.push_back(
+            std::allocate_shared<Lambda>(PoolAllocator<Lambda>(), chunk->lambdas[ip->arg], frame));
+        ++ip;
+        DISPATCH();
+    }
+
+    TARGET(kCall) {
+        tail = false;
+        goto call;
+    }
+
+    TARGET(kTailCall) {
+        tail = true;
+        goto call;
+    }
+
+    TARGET(kCallBuiltin) {
+        const Chunk::BuiltinCall& call = chunk->builtins[ip->arg];
+        Arguments args(stack.data() + stack.size() - call.argc, call.argc);
+        if (call.redefinitions == builtin_redefinitions) {
+            value = (*call.function)(args);
+        }
+        else {
+            // a builtin got a global definition since, see BuiltinCallNode
+            value = Apply(LookUpGlobal(call.name), args);
+        }
+        stack.resize(stack.size() - call.argc);
+        stack.push_back(std::move(value));
+        ++ip;
+        DISPATCH();
+    }
+
+    TARGET(kReturn) {
+        if (frames.empty()) {
+            return std::move(stack.back());
+        }
+        SuspendedCall& caller = frames.back();
+        closure = std::move(caller.closure);
+        chunk = caller.chunk;
+        ip = caller.ip;
+        frame = std::move(caller.frame);
+        frames.pop_back();
+        DISPATCH();
+    }
+
+#ifndef SCHEME_COMPUTED_GOTO
+    }
+#endif
+
+call:
+    argc = ip->arg;
+    {
+        auto& function = stack[stack.size() - argc - 1];
+        Arguments args(stack.data() + stack.size() - argc, argc);
+        if (Is<Lambda>(function) && static_cast<Lambda*>(function.get())->GetCode().chunk) {
+            auto* lambda = static_cast<Lambda*>(function.get());
+            auto callee_frame = MakeFrame(*lambda, args);
+            if (!tail) {
+                if (frames.size() == depth_limit) {
+                    throw RuntimeError("Maximum recursion depth exceeded");
+                }
+                frames.push_back({std::move(closure), chunk, ip + 1, std::move(frame)});
+            }
+            closure = std::move(function);
+            chunk = lambda->GetCode().chunk.get();
+            ip = chunk->code.data();
+            frame = std::move(callee_frame);
+            stack.resize(stack.size() - argc - 1);
+        }
+        else {
+            value = Apply(function, args);
+            stack.resize(stack.size() - argc - 1);
+            stack.push_back(std::move(value));
+            ++ip;
+        }
+    }
+    DISPATCH();
+
+#undef DISPATCH
+#undef TARGET
+}
+
+// Runs a compiled top-level form.
+class BytecodeNode : public Node {
+public:
+    BytecodeNode(Chunk chunk, size_t depth_limit)
+        : chunk_(std::move(chunk)), depth_limit_(depth_limit) {
+    }
+
+    std::shared_ptr<Object> Eval(const std::shared_ptr<Frame>& frame) override {
+        return Run(chunk_, frame, depth_limit_);
+    }
+
+    void Emit(Chunk*, bool) override {
+        throw RuntimeError("A compiled form can not be emitted again");
+    }
+
+private:
+    Chunk chunk_;
+    size_t depth_limit_;
+};
+
+}  // namespace
+
+uint32_t Chunk::Emit(Opcode op, uint32_t arg) {
+    code.push_back({op, 0, arg});
+    return code.size() - 1;
+}
+
+uint32_t Chunk::Emit(Opcode op, Address address) {
+    if (address.depth > UINT16_MAX) {
+        throw RuntimeError("Too many nested lambdas");
+    }
+    code.push_back({op, static_cast<uint16_t>(address.depth), address.index});
+    return code.size() - 1;
+}
+
+void Chunk::PatchJump(uint32_t at) {
+    code[at].arg = code.size();
+}
+
+uint32_t Chunk::AddConstant(std::shared_ptr<Object> value) {
+    constants.push_back(std::move(value));
+    return constants.size() - 1;
+}
+
+uint32_t Chunk::AddLambda(std::shared_ptr<const LambdaCode> lambda) {
+    lambdas.push_back(std::move(lambda));
+    return lambdas.size() - 1;
+}
+
+uint32_t Chunk::AddBuiltinCall(BuiltinCall call) {
+    builtins.push_back(call);
+    return builtins.size() - 1;
+}
+
+uint32_t Chunk::AddLocal(Local local) {
+    locals.push_back(local);
+    return locals.size() - 1;
+}
+
+std::shared_ptr<const Chunk> CompileBody(const LambdaCode& lambda) {
+    auto chunk = std::make_shared<Chunk>();
+    for (size_t i = 0; i + 1 < lambda.body.size(); ++i) {
+        lambda.body[i]->Emit(chunk.get(), false);
+        chunk->Emit(Opcode::kPop);
+    }
+    lambda.body.back()->Emit(chunk.get(), true);
+    chunk->Emit(Opcode::kReturn);
+    return chunk;
+}
+
+NodePtr CompileBytecode(const std::shared_ptr<Object>& form, size_t call_depth_limit) {
+    Chunk chunk;
+    Compile(form)->Emit(&chunk, false);
+    chunk.Emit(Opcode::kReturn);
+    return std::make_unique<BytecodeNode>(std::move(chunk), call_depth_limit);
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <compiler.h>
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// The bytecode machine, the second evaluator next to the tree of nodes. The code is emitted
+// from the compiled nodes, so both evaluators agree on what every form means. The machine
+// keeps its operands and the frames of the calls between closures on heap stacks, calls in
+// tail position replace the frame of the caller. So the depth of recursion is limited by memory
+// only, or by the limit given to CompileBytecode.
+
+enum class Opcode : uint8_t {
+    kConstant,      // pushes constants[arg]
+    kLoadLocal,     // pushes the local variable at (depth, arg)
+    kLoadChecked,   // pushes the internal definition locals[arg], which may be unassigned yet
+    kLoadGlobal,    // pushes the global variable arg
+    kDefineLocal,   // pops the value of the internal definition into the slot arg
+    kDefineGlobal,  // pops the value of the global variable arg
+    kSetLocal,      // pops the new value of the local variable at (depth, arg)
+    kSetChecked,    // pops the new value of the internal definition locals[arg]
+    kSetGlobal,     // pops the new value of the global variable arg
+    kPop,
+    kJump,          // to arg
+    kJumpIfFalse,   // pops the condition of an if, jumps to arg if it is #f
+    kBranchFalse,   // jumps to arg if the top is #f, and pops it otherwise
+    kBranchTrue,    // jumps to arg if the top is not #f, and pops it otherwise
+    kClosure,       // pushes a closure of lambdas[arg] over the current frame
+    kCall,          // calls the function below arg arguments
+    kTailCall,      // the same, in place of the current call
+    kCallBuiltin,   // calls builtins[arg] with the arguments on top
+    kReturn,
+};
+
+struct Instruction {
+    Opcode op;
+    // frames out, for the local variables
+    uint16_t depth;
+    uint32_t arg;
+};
+
+// The code of a top-level form or of a lambda body.
+struct Chunk {
+    // A call bound to a builtin, see BuiltinCallNode.
+    struct BuiltinCall {
+        SymbolId name;
+        Function* function;
+        size_t redefinitions;
+        uint32_t argc;
+    };
+
+    // The name of a checked local variable, for the error when it is unassigned.
+    struct Local {
+        Address address;
+        SymbolId name;
+    };
+
+    uint32_t Emit(Opcode op, uint32_t arg = 0);
+
+    // Throws RuntimeError if the variable is nested too deep for an instruction.
+    uint32_t Emit(Opcode op, Address address);
+
+    // Points the jump emitted at `at` to the next instruction.
+    void PatchJump(uint32_t at);
+
+    uint32_t AddConstant(std::shared_ptr<Object> value);
+    uint32_t AddLambda(std::shared_ptr<const LambdaCode> lambda);
+    uint32_t AddBuiltinCall(BuiltinCall call);
+    uint32_t AddLocal(Local local);
+
+    std::vector<Instruction> code;
+    std::vector<std::shared_ptr<Object>> constants;
+    std::vector<std::shared_ptr<const LambdaCode>> lambdas;
+    std::vector<BuiltinCall> builtins;
+    std::vector<Local> locals;
+};
+
+// The code of the body of a lambda, which returns the value of its last form.
+std::shared_ptr<const Chunk> CompileBody(const LambdaCode& lambda);
+
+// Like Compile, but the returned node runs the form on the bytecode machine. Its calls may nest
+// up to call_depth_limit deep, deeper ones throw RuntimeError.
+NodePtr CompileBytecode(const std::shared_ptr<Object>& form, size_t call_depth_limit);
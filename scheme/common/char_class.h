@@ -0,0 +1,65 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <cstdio>
+#include <limits>
+#include <string_view>
+
+// Character classification shared by the tokenizers of every stage. Each byte maps to a
+// bit mask of the classes it belongs to, so one table load answers any class question.
+
+enum CharClass : uint8_t {
+    kSpaceClass = 1 << 0,
+    kDigitClass = 1 << 1,
+    kSymbolStartClass = 1 << 2,
+    kSymbolClass = 1 << 3,
+};
+
+constexpr std::array<uint8_t, 256> MakeCharClassTable() {
+    std::array<uint8_t, 256> table{};
+    for (char c : std::string_view(" \n")) {
+        table[static_cast<unsigned char>(c)] |= kSpaceClass;
+    }
+    for (char c = '0'; c <= '9'; ++c) {
+        table[static_cast<unsigned char>(c)] |= kDigitClass | kSymbolClass;
+    }
+    for (char c = 'a'; c <= 'z'; ++c) {
+        table[static_cast<unsigned char>(c)] |= kSymbolStartClass | kSymbolClass;
+        table[static_cast<unsigned char>(c - 'a' + 'A')] |= kSymbolStartClass | kSymbolClass;
+    }
+    for (char c : std::string_view("<=>*/#")) {
+        table[static_cast<unsigned char>(c)] |= kSymbolStartClass | kSymbolClass;
+    }
+    for (char c : std::string_view("?!-")) {
+        table[static_cast<unsigned char>(c)] |= kSymbolClass;
+    }
+    return table;
+}
+
+inline constexpr std::array<uint8_t, 256> kCharClassTable = MakeCharClassTable();
+
+// Accepts the result of istream::peek, EOF belongs to no class.
+constexpr bool HasCharClass(int c, CharClass cls) {
+    return c != EOF && (kCharClassTable[static_cast<unsigned char>(c)] & cls) != 0;
+}
+
+// Appends a decimal digit to a number being read, returns false if the result does not fit
+// into Int. Negative numbers are accumulated below zero so that the minimum is reachable.
+template <class Int>
+constexpr bool AppendDigit(Int* value, int digit, bool negative) {
+    constexpr Int kMax = std::numeric_limits<Int>::max();
+    constexpr Int kMin = std::numeric_limits<Int>::min();
+    if (negative) {
+        if (*value < (kMin + digit) / 10) {
+            return false;
+        }
+        *value = *value * 10 - digit;
+    } else {
+        if (*value > (kMax - digit) / 10) {
+            return false;
+        }
+        *value = *value * 10 + digit;
+    }
+    return true;
+}
@@ -0,0 +1,82 @@
+#include <parser.h>
+
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+
+namespace {
+
+constexpr uint32_t kSeed = 16;
+
+template <class F>
+double Seconds(F&& f) {
+    auto start = std::chrono::steady_clock::now();
+    f();
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count();
+}
+
+void ReportThroughput(const std::string& name, size_t bytes, double seconds) {
+    std::cout << name << ": " << bytes / seconds / (1 << 20) << " MB/s" << std::endl;
+}
+
+// A data dump: a sequence of small nested records.
+std::string GenerateSource(size_t size) {
+    static const char* kSymbols[] = {"id", "name", "value", "tags", "#t", "#f", "foo-bar-baz"};
+    std::mt19937 gen(kSeed);
+    std::uniform_int_distribution<int> number(-100000, 100000);
+    std::uniform_int_distribution<size_t> symbol(0, std::size(kSymbols) - 1);
+    std::string source;
+    while (source.size() < size) {
+        source += "\n(" + std::string(kSymbols[symbol(gen)]) + " " + std::to_string(number(gen));
+        source += " (" + std::string(kSymbols[symbol(gen)]) + " . " +
+                  std::to_string(number(gen)) + "))";
+    }
+    return source;
+}
+
+template <class T>
+size_t CountTokens(T* tokenizer) {
+    size_t count = 0;
+    for (; !tokenizer->IsEnd(); tokenizer->Next()) {
+        ++count;
+    }
+    return count;
+}
+
+}  // namespace
+
+int main() {
+    std::string source = GenerateSource(64 << 20);
+    size_t count = 0;
+
+    double time = Seconds([&] { count += BuildStructuralIndexScalar(source).size(); });
+    ReportThroughput("index/scalar", source.size(), time);
+    time = Seconds([&] { count += BuildStructuralIndex(source).size(); });
+    ReportThroughput("index/dispatched", source.size(), time);
+
+    time = Seconds([&] {
+        std::stringstream ss{source};
+        Tokenizer tokenizer{&ss};
+        count += CountTokens(&tokenizer);
+    });
+    ReportThroughput("tokenizer/stream", source.size(), time);
+    time = Seconds([&] {
+        StructuralTokenizer tokenizer{source};
+        count += CountTokens(&tokenizer);
+    });
+    ReportThroughput("tokenizer/structural", source.size(), time);
+
+    time = Seconds([&] {
+        StructuralTokenizer tokenizer{source};
+        while (!tokenizer.IsEnd()) {
+            Read(&tokenizer);
+        }
+    });
+    ReportThroughput("read/structural", source.size(), time);
+
+    std::cout << "checksum: " << count << std::endl;
+    return 0;
+}
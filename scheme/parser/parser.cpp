@@ -20,7 +20,16 @@ Cell::Cell(const std::shared_ptr<Object>& first, const std::shared_ptr<Object>&
     : first_(first), second_(second) {
 }
 
-std::shared_ptr<Object> Read(Tokenizer* tokenizer) {
+namespace {
+
+template <class T>
+std::shared_ptr<Object> ReadFrom(T* tokenizer);
+
+template <class T>
+std::shared_ptr<Object> ReadListFrom(T* tokenizer);
+
+template <class T>
+std::shared_ptr<Object> ReadFrom(T* tokenizer) {
 
     if (tokenizer->IsEnd()) {
         throw SyntaxError("Empty");
@@ -32,7 +41,7 @@ std::shared_ptr<Object> Read(Tokenizer* tokenizer) {
         return std::make_shared<Number>(std::get<ConstantToken>(t).value);
     } else if (std::get_if<BracketToken>(&t)) {
         if (std::get<BracketToken>(t) == BracketToken::OPEN) {
-            return ReadList(tokenizer);
+            return ReadListFrom(tokenizer);
         } else {
             throw SyntaxError("No matching open bracket for close bracket");
         }
@@ -62,7 +71,8 @@ std::shared_ptr<Object> BuildList(const std::vector<std::shared_ptr<Object>>& li
     }
 }
 
-std::shared_ptr<Object> ReadList(Tokenizer* tokenizer) {
+template <class T>
+std::shared_ptr<Object> ReadListFrom(T* tokenizer) {
 
     if (tokenizer->IsEnd()) {
         throw SyntaxError("No matching close bracket for open bracket");
@@ -74,7 +84,7 @@ std::shared_ptr<Object> ReadList(Tokenizer* tokenizer) {
 
     while (!tokenizer->IsEnd() &&
            !(std::get_if<BracketToken>(&t) && std::get<BracketToken>(t) == BracketToken::CLOSE)) {
-        list.push_back(Read(tokenizer));
+        list.push_back(ReadFrom(tokenizer));
         if (!tokenizer->IsEnd()) {
             t = tokenizer->GetToken();
         }
@@ -84,4 +94,22 @@ std::shared_ptr<Object> ReadList(Tokenizer* tokenizer) {
     }
     tokenizer->Next();
     return BuildList(list, 0);
-}
\ No newline at end of file
+}
+
+}  // namespace
+
+std::shared_ptr<Object> Read(Tokenizer* tokenizer) {
+    return ReadFrom(tokenizer);
+}
+
+std::shared_ptr<Object> ReadList(Tokenizer* tokenizer) {
+    return ReadListFrom(tokenizer);
+}
+
+std::shared_ptr<Object> Read(StructuralTokenizer* tokenizer) {
+    return ReadFrom(tokenizer);
+}
+
+std::shared_ptr<Object> ReadList(StructuralTokenizer* tokenizer) {
+    return ReadListFrom(tokenizer);
+}
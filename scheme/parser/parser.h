@@ -4,6 +4,11 @@
 
 #include "object.h"
 #include <tokenizer.h>
+#include <structural_index.h>
 
 std::shared_ptr<Object> Read(Tokenizer* tokenizer);
 std::shared_ptr<Object> ReadList(Tokenizer* tokenizer);
+
+// Same as above, over a buffer tokenized with the structural index.
+std::shared_ptr<Object> Read(StructuralTokenizer* tokenizer);
+std::shared_ptr<Object> ReadList(StructuralTokenizer* tokenizer);
@@ -1,6 +1,7 @@
 add_library(scheme_parser
     tokenizer.cpp
     parser.cpp
+    structural_index.cpp
     
     # maybe more .cpp files here
 )
@@ -0,0 +1,244 @@
+#include <structural_index.h>
+#include <error.h>
+#include <char_class.h>
+
+#include <cstring>
+#include <limits>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define SCHEME_STRUCTURAL_X86
+#include <immintrin.h>
+#endif
+
+namespace {
+
+const size_t kBlockSize = 64;
+
+// Bit i of `separators` is set when byte i of the block is a space or a structural character,
+// bit i of `structurals` when it is a bracket, a quote or a dot.
+struct BlockMasks {
+    uint64_t separators;
+    uint64_t structurals;
+};
+
+bool IsStructural(char c) {
+    return c == '(' || c == ')' || c == '\'' || c == '.';
+}
+
+BlockMasks ScanBlockScalar(const char* block) {
+    BlockMasks masks{0, 0};
+    for (size_t i = 0; i < kBlockSize; ++i) {
+        uint64_t bit = uint64_t(1) << i;
+        if (IsStructural(block[i])) {
+            masks.structurals |= bit;
+            masks.separators |= bit;
+        } else if (HasCharClass(block[i], kSpaceClass)) {
+            masks.separators |= bit;
+        }
+    }
+    return masks;
+}
+
+#ifdef SCHEME_STRUCTURAL_X86
+
+__attribute__((target("avx2"))) inline BlockMasks ScanBlockAvx2(const char* block) {
+    BlockMasks masks{0, 0};
+    for (size_t half = 0; half < 2; ++half) {
+        __m256i in = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(block + half * 32));
+        __m256i structurals = _mm256_or_si256(
+            _mm256_or_si256(_mm256_cmpeq_epi8(in, _mm256_set1_epi8('(')),
+                            _mm256_cmpeq_epi8(in, _mm256_set1_epi8(')'))),
+            _mm256_or_si256(_mm256_cmpeq_epi8(in, _mm256_set1_epi8('\'')),
+                            _mm256_cmpeq_epi8(in, _mm256_set1_epi8('.'))));
+        __m256i spaces = _mm256_or_si256(_mm256_cmpeq_epi8(in, _mm256_set1_epi8(' ')),
+                                         _mm256_cmpeq_epi8(in, _mm256_set1_epi8('\n')));
+        uint64_t structural_bits = static_cast<uint32_t>(_mm256_movemask_epi8(structurals));
+        uint64_t space_bits = static_cast<uint32_t>(_mm256_movemask_epi8(spaces));
+        masks.structurals |= structural_bits << (half * 32);
+        masks.separators |= (structural_bits | space_bits) << (half * 32);
+    }
+    return masks;
+}
+
+// SSE2 is part of x86-64, so this one needs no runtime check.
+BlockMasks ScanBlockSse2(const char* block) {
+    BlockMasks masks{0, 0};
+    for (size_t quarter = 0; quarter < 4; ++quarter) {
+        __m128i in = _mm_loadu_si128(reinterpret_cast<const __m128i*>(block + quarter * 16));
+        __m128i structurals =
+            _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(in, _mm_set1_epi8('(')),
+                                      _mm_cmpeq_epi8(in, _mm_set1_epi8(')'))),
+                         _mm_or_si128(_mm_cmpeq_epi8(in, _mm_set1_epi8('\'')),
+                                      _mm_cmpeq_epi8(in, _mm_set1_epi8('.'))));
+        __m128i spaces = _mm_or_si128(_mm_cmpeq_epi8(in, _mm_set1_epi8(' ')),
+                                      _mm_cmpeq_epi8(in, _mm_set1_epi8('\n')));
+        uint64_t structural_bits = static_cast<uint32_t>(_mm_movemask_epi8(structurals));
+        uint64_t space_bits = static_cast<uint32_t>(_mm_movemask_epi8(spaces));
+        masks.structurals |= structural_bits << (quarter * 16);
+        masks.separators |= (structural_bits | space_bits) << (quarter * 16);
+    }
+    return masks;
+}
+
+#endif
+
+// Inlined into each kernel below, so that the block scan is compiled for the kernel's target.
+template <BlockMasks (*ScanBlock)(const char*)>
+__attribute__((always_inline)) inline std::vector<uint32_t> BuildIndex(std::string_view buffer) {
+    if (buffer.size() > std::numeric_limits<uint32_t>::max()) {
+        throw SyntaxError("Input is too large for the structural index");
+    }
+    // dense sources have a structural character every few bytes, start with room for that
+    std::vector<uint32_t> index(buffer.size() / 4 + kBlockSize);
+    size_t count = 0;
+    // the start of the input works as a separator before the first character
+    uint64_t prev_separator = 1;
+    for (size_t base = 0; base < buffer.size(); base += kBlockSize) {
+        BlockMasks masks;
+        uint64_t valid = ~uint64_t(0);
+        if (buffer.size() - base >= kBlockSize) {
+            masks = ScanBlock(buffer.data() + base);
+        } else {
+            char tail[kBlockSize];
+            std::memset(tail, ' ', kBlockSize);
+            std::memcpy(tail, buffer.data() + base, buffer.size() - base);
+            masks = ScanBlock(tail);
+            valid = (uint64_t(1) << (buffer.size() - base)) - 1;
+        }
+        uint64_t run_starts = ~masks.separators & ((masks.separators << 1) | prev_separator);
+        prev_separator = masks.separators >> 63;
+        uint64_t bits = (masks.structurals | run_starts) & valid;
+
+        if (index.size() - count < kBlockSize) {
+            index.resize(index.size() * 2);
+        }
+        uint32_t* out = index.data() + count;
+        count += __builtin_popcountll(bits);
+        while (bits != 0) {
+            *out++ = base + __builtin_ctzll(bits);
+            bits &= bits - 1;
+        }
+    }
+    index.resize(count);
+    return index;
+}
+
+std::vector<uint32_t> BuildIndexScalar(std::string_view buffer) {
+    return BuildIndex<ScanBlockScalar>(buffer);
+}
+
+#ifdef SCHEME_STRUCTURAL_X86
+
+__attribute__((target("avx2,popcnt,bmi"))) std::vector<uint32_t> BuildIndexAvx2(
+    std::string_view buffer) {
+    return BuildIndex<ScanBlockAvx2>(buffer);
+}
+
+std::vector<uint32_t> BuildIndexSse2(std::string_view buffer) {
+    return BuildIndex<ScanBlockSse2>(buffer);
+}
+
+#endif
+
+std::vector<uint32_t> (*SelectKernel())(std::string_view) {
+#ifdef SCHEME_STRUCTURAL_X86
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("popcnt") &&
+        __builtin_cpu_supports("bmi")) {
+        return BuildIndexAvx2;
+    }
+    return BuildIndexSse2;
+#else
+    return BuildIndexScalar;
+#endif
+}
+
+}  // namespace
+
+std::vector<uint32_t> BuildStructuralIndex(std::string_view buffer) {
+    static const auto kKernel = SelectKernel();
+    return kKernel(buffer);
+}
+
+std::vector<uint32_t> BuildStructuralIndexScalar(std::string_view buffer) {
+    return BuildIndexScalar(buffer);
+}
+
+StructuralTokenizer::StructuralTokenizer(std::string_view buffer)
+    : buffer_(buffer), index_(BuildStructuralIndex(buffer)), next_(0), pos_(0), in_run_(false) {
+    Next();
+}
+
+bool StructuralTokenizer::IsEnd() {
+    return !token_;
+}
+
+void StructuralTokenizer::Next() {
+    // a run like "1abc" holds several tokens, only its start is in the index
+    if (in_run_) {
+        ReadScalar();
+        return;
+    }
+    if (next_ == index_.size()) {
+        token_.reset();
+        return;
+    }
+    pos_ = index_[next_++];
+    char curr = buffer_[pos_];
+    if (curr == '(') {
+        ++pos_;
+        token_ = BracketToken::OPEN;
+    } else if (curr == ')') {
+        ++pos_;
+        token_ = BracketToken::CLOSE;
+    } else if (curr == '\'') {
+        ++pos_;
+        token_ = QuoteToken();
+    } else if (curr == '.') {
+        ++pos_;
+        token_ = DotToken();
+    } else {
+        ReadScalar();
+    }
+}
+
+Token StructuralTokenizer::GetToken() {
+    return *token_;
+}
+
+// Same rules as Tokenizer::Next for numbers and symbols, starting at pos_.
+void StructuralTokenizer::ReadScalar() {
+    char curr = buffer_[pos_];
+    bool sign = curr == '+' || curr == '-';
+    if (HasCharClass(curr, kDigitClass) ||
+        (sign && pos_ + 1 < buffer_.size() && HasCharClass(buffer_[pos_ + 1], kDigitClass))) {
+        bool negative = curr == '-';
+        if (sign) {
+            ++pos_;
+        }
+        int value = 0;
+        while (pos_ < buffer_.size() && HasCharClass(buffer_[pos_], kDigitClass)) {
+            if (!AppendDigit(&value, buffer_[pos_] - '0', negative)) {
+                throw SyntaxError("Number is too big");
+            }
+            ++pos_;
+        }
+        token_ = ConstantToken(value);
+    } else if (sign) {
+        ++pos_;
+        token_ = SymbolToken(std::string(1, curr));
+    } else if (HasCharClass(curr, kSymbolStartClass)) {
+        size_t start = pos_;
+        while (pos_ < buffer_.size() && HasCharClass(buffer_[pos_], kSymbolClass)) {
+            ++pos_;
+        }
+        if (pos_ < buffer_.size() && !HasCharClass(buffer_[pos_], kSpaceClass) &&
+            buffer_[pos_] != ')') {
+            throw SyntaxError("Unresolved mid character");
+        }
+        token_ = SymbolToken(std::string(buffer_.substr(start, pos_ - start)));
+    } else {
+        throw SyntaxError("Unresolved start character");
+    }
+    in_run_ = pos_ < buffer_.size() && !HasCharClass(buffer_[pos_], kSpaceClass) &&
+              !IsStructural(buffer_[pos_]);
+}
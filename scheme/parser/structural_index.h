@@ -0,0 +1,39 @@
+#pragma once
+
+#include <tokenizer.h>
+
+#include <cstdint>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+// Stage one of tokenizing a large buffer: a SIMD pass over 64-byte blocks that records the
+// offset of every bracket, quote and dot and of the first character of every run of other
+// non-space characters. The widest kernel the CPU supports is picked at runtime.
+std::vector<uint32_t> BuildStructuralIndex(std::string_view buffer);
+
+// Scalar version of the kernel, kept for testing the vectorized ones against it.
+std::vector<uint32_t> BuildStructuralIndexScalar(std::string_view buffer);
+
+// Stage two: produces the same tokens as Tokenizer, but jumps over whitespace using the
+// structural index. The buffer must outlive the tokenizer.
+class StructuralTokenizer {
+public:
+    StructuralTokenizer(std::string_view buffer);
+
+    bool IsEnd();
+
+    void Next();
+
+    Token GetToken();
+
+private:
+    void ReadScalar();
+
+    std::string_view buffer_;
+    std::vector<uint32_t> index_;
+    size_t next_;
+    size_t pos_;
+    bool in_run_;
+    std::optional<Token> token_;
+};
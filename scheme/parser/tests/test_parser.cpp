@@ -154,3 +154,87 @@ TEST_CASE("Invalid") {
     REQUIRE_THROWS_AS(ReadFull("(1 . )"), SyntaxError);
     REQUIRE_THROWS_AS(ReadFull("(1 . 2 3)"), SyntaxError);
 }
+
+namespace {
+
+std::string RandomSource(std::default_random_engine* rng, size_t size) {
+    static const std::string kPieces[] = {"(", ")", "'", ".", " ", "\n", "  ", "12", "-7", "+",
+                                          "-", "foo", "x?", "#t", "1abc", "+-"};
+    std::uniform_int_distribution<size_t> piece(0, std::size(kPieces) - 1);
+    std::string s;
+    while (s.size() < size) {
+        s += kPieces[piece(*rng)];
+    }
+    return s;
+}
+
+template <class T>
+void DumpTokens(T* tokenizer, std::vector<std::string>* tokens) {
+    for (; !tokenizer->IsEnd(); tokenizer->Next()) {
+        auto token = tokenizer->GetToken();
+        if (auto number = std::get_if<ConstantToken>(&token)) {
+            tokens->push_back(std::to_string(number->value));
+        } else if (auto symbol = std::get_if<SymbolToken>(&token)) {
+            tokens->push_back("s:" + symbol->name);
+        } else {
+            tokens->push_back("#" + std::to_string(token.index()));
+        }
+    }
+}
+
+}  // namespace
+
+TEST_CASE("Structural index kernels agree") {
+    std::default_random_engine rng{42};
+    for (size_t size : {0, 1, 63, 64, 65, 127, 128, 1000, 4099}) {
+        auto source = RandomSource(&rng, size);
+        REQUIRE(BuildStructuralIndex(source) == BuildStructuralIndexScalar(source));
+    }
+
+    std::string source = " (ab  12)'x.\n";
+    std::vector<uint32_t> expected{1, 2, 6, 8, 9, 10, 11};
+    REQUIRE(BuildStructuralIndex(source) == expected);
+}
+
+TEST_CASE("Structural tokenizer matches tokenizer") {
+    std::default_random_engine rng{7};
+    for (int i = 0; i < 500; ++i) {
+        auto source = RandomSource(&rng, i % 200);
+
+        std::vector<std::string> expected;
+        try {
+            std::stringstream ss{source};
+            Tokenizer tokenizer{&ss};
+            DumpTokens(&tokenizer, &expected);
+        } catch (const SyntaxError& error) {
+            expected.push_back(error.what());
+        }
+
+        std::vector<std::string> tokens;
+        try {
+            StructuralTokenizer tokenizer{source};
+            DumpTokens(&tokenizer, &tokens);
+        } catch (const SyntaxError& error) {
+            tokens.push_back(error.what());
+        }
+
+        REQUIRE(tokens == expected);
+    }
+}
+
+TEST_CASE("Read with the structural tokenizer") {
+    StructuralTokenizer tokenizer{"(1 (foo . -2)) bar"};
+    auto list = Read(&tokenizer);
+    REQUIRE(Is<Cell>(list));
+    REQUIRE(As<Number>(As<Cell>(list)->GetFirst())->GetValue() == 1);
+    auto pair = As<Cell>(As<Cell>(As<Cell>(list)->GetSecond())->GetFirst());
+    REQUIRE(As<Symbol>(pair->GetFirst())->GetName() == "foo");
+    REQUIRE(As<Number>(pair->GetSecond())->GetValue() == -2);
+
+    REQUIRE(As<Symbol>(Read(&tokenizer))->GetName() == "bar");
+    REQUIRE(tokenizer.IsEnd());
+
+    StructuralTokenizer unbalanced{"(1 (2)"};
+    REQUIRE_THROWS_AS(Read(&unbalanced), SyntaxError);
+    REQUIRE_THROWS_WITH(StructuralTokenizer{"2147483648"}, "Number is too big");
+}
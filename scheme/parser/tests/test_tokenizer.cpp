@@ -153,3 +153,12 @@ TEST_CASE("Empty string handled correctly") {
 
     REQUIRE(tokenizer.IsEnd());
 }
+
+TEST_CASE("Unresolved characters") {
+    std::stringstream mid{"foo@"};
+    REQUIRE_THROWS_WITH(Tokenizer{&mid}, "Unresolved mid character");
+    std::stringstream start{"@"};
+    REQUIRE_THROWS_WITH(Tokenizer{&start}, "Unresolved start character");
+    std::stringstream big{"2147483648"};
+    REQUIRE_THROWS_WITH(Tokenizer{&big}, "Number is too big");
+}
@@ -1,18 +1,27 @@
 #include <tokenizer.h>
 #include <error.h>
+#include <char_class.h>
 
-const char kSpace = ' ';
-const char kEndLine = '\n';
 const char kLeftBracket = '(';
 const char kRightBracket = ')';
 const char kQuote = '\'';
 const char kDot = '.';
 const char kPlus = '+';
 const char kMinus = '-';
-const std::string kStartPossibleChar = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ<=>*/#";
-const std::string kOtherPossibleChar =
-    "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ<=>*/#0123456789?!-";
-const std::string kDigits = "0123456789";
+
+namespace {
+
+int ReadNumber(std::istream* in, bool negative) {
+    int value = 0;
+    while (HasCharClass(in->peek(), kDigitClass)) {
+        if (!AppendDigit(&value, in->get() - '0', negative)) {
+            throw SyntaxError("Number is too big");
+        }
+    }
+    return value;
+}
+
+}  // namespace
 
 SymbolToken::SymbolToken(const std::string& val) : name(val) {
 }
@@ -49,14 +58,14 @@ bool Tokenizer::IsEnd() {
 }
 
 void Tokenizer::Next() {
-    while (in_->peek() == kSpace || in_->peek() == kEndLine) {
+    while (HasCharClass(in_->peek(), kSpaceClass)) {
         in_->get();
     }
     if (in_->peek() == EOF) {
         token_.reset(nullptr);
         return;
     }
-    char curr = in_->peek();
+    int curr = in_->peek();
     if (curr == kLeftBracket) {
         in_->get();
         token_.reset(new Token(BracketToken::OPEN));
@@ -69,46 +78,22 @@ void Tokenizer::Next() {
     } else if (curr == kDot) {
         in_->get();
         token_.reset(new Token(DotToken()));
-    } else if (kDigits.find(curr) != std::string::npos) {
-        std::string temp;
-        while (kDigits.find(curr) != std::string::npos) {
-            temp.push_back(in_->get());
-            curr = in_->peek();
-        }
-        token_.reset(new Token(ConstantToken(std::stoi(temp))));
-    } else if (curr == kPlus) {
-        std::string temp;
-        temp.push_back(in_->get());
-        curr = in_->peek();
-        if (kDigits.find(curr) != std::string::npos) {
-            while (kDigits.find(curr) != std::string::npos) {
-                temp.push_back(in_->get());
-                curr = in_->peek();
-            }
-            token_.reset(new Token(ConstantToken(std::stoi(temp))));
-        } else {
-            token_.reset(new Token(SymbolToken(temp)));
-        }
-    } else if (curr == kMinus) {
-        std::string temp;
-        temp.push_back(in_->get());
-        curr = in_->peek();
-        if (kDigits.find(curr) != std::string::npos) {
-            while (kDigits.find(curr) != std::string::npos) {
-                temp.push_back(in_->get());
-                curr = in_->peek();
-            }
-            token_.reset(new Token(ConstantToken(std::stoi(temp))));
+    } else if (HasCharClass(curr, kDigitClass)) {
+        token_.reset(new Token(ConstantToken(ReadNumber(in_, false))));
+    } else if (curr == kPlus || curr == kMinus) {
+        in_->get();
+        if (HasCharClass(in_->peek(), kDigitClass)) {
+            token_.reset(new Token(ConstantToken(ReadNumber(in_, curr == kMinus))));
         } else {
-            token_.reset(new Token(SymbolToken(temp)));
+            token_.reset(new Token(SymbolToken(std::string(1, curr))));
         }
-    } else if (kStartPossibleChar.find(curr) != std::string::npos) {
+    } else if (HasCharClass(curr, kSymbolStartClass)) {
         std::string temp;
-        while (kOtherPossibleChar.find(curr) != std::string::npos) {
+        while (HasCharClass(curr, kSymbolClass)) {
             temp.push_back(in_->get());
             curr = in_->peek();
         }
-        if (curr != EOF && curr != kSpace && curr != kEndLine) {
+        if (curr != EOF && !HasCharClass(curr, kSpaceClass) && curr != kRightBracket) {
             throw SyntaxError("Unresolved mid character");
         } else {
             token_.reset(new Token(SymbolToken(temp)));
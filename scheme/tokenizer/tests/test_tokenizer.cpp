@@ -153,3 +153,19 @@ TEST_CASE("Empty string handled correctly") {
 
     REQUIRE(tokenizer.IsEnd());
 }
+
+TEST_CASE("Number limits") {
+    std::stringstream ss{"2147483647 -2147483648 +0012"};
+    Tokenizer tokenizer{&ss};
+
+    REQUIRE(tokenizer.GetToken() == Token{ConstantToken{2147483647}});
+    tokenizer.Next();
+    REQUIRE(tokenizer.GetToken() == Token{ConstantToken{-2147483647 - 1}});
+    tokenizer.Next();
+    REQUIRE(tokenizer.GetToken() == Token{ConstantToken{12}});
+
+    std::stringstream too_big{"2147483648"};
+    REQUIRE_THROWS_WITH(Tokenizer{&too_big}, "Number is too big");
+    std::stringstream too_small{"-2147483649"};
+    REQUIRE_THROWS_WITH(Tokenizer{&too_small}, "Number is too big");
+}